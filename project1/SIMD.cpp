@@ -4,6 +4,8 @@
 #include <random>
 #include <chrono>
 #include <emmintrin.h>
+#include <immintrin.h>
+#include "SM4-Core.h"
 
 using namespace std;
 
@@ -39,6 +41,9 @@ const uint32_t ROUND_KEY_PARAMS[32] = {
 // T盒存储结构
 uint32_t T_BOX0[256], T_BOX1[256], T_BOX2[256], T_BOX3[256];
 
+// 32位宽的S盒，供AVX2 gather按通道查表
+uint32_t SM4_SUB_BOX32[256];
+
 // 循环左移操作
 inline uint32_t left_rotate(uint32_t value, int shift) {
     return (value << shift) | (value >> (32 - shift));
@@ -56,10 +61,117 @@ void initialize_tbox() {
         unsigned char s_val = SM4_SUB_BOX[i];
         uint32_t trans_val = L_transform(static_cast<uint32_t>(s_val) << 24);
         T_BOX0[i] = trans_val;
-        T_BOX1[i] = left_rotate(trans_val, 8);
+        T_BOX1[i] = left_rotate(trans_val, 24);
         T_BOX2[i] = left_rotate(trans_val, 16);
-        T_BOX3[i] = left_rotate(trans_val, 24);
+        T_BOX3[i] = left_rotate(trans_val, 8);
+        SM4_SUB_BOX32[i] = s_val;
+    }
+}
+
+// ---- 复合域S盒（SSSE3 pshufb实现用） ----
+// SM4的S盒可写成 S(x) = A·I(A·x + C) + C：I为模 f(x)=x^8+x^7+x^6+x^5+x^4+x^2+1 的求逆，
+// A为首行0xD3的循环矩阵，C=0xD3。把求逆映射到复合域GF((2^4)^2)后，
+// 所有运算都变成4比特查表，可以用pshufb在寄存器内完成，不再按数据访问内存。
+
+// 复合域 GF(2^4)[y]/(y^2+y+λ)，字节高4位为y的系数；GF(2^4)取模 x^4+x+1
+uint8_t TOWER_LAMBDA;
+
+// pshufb用的16字节表
+alignas(16) uint8_t NIBBLE_IN_LO[16], NIBBLE_IN_HI[16];    // 输入仿射变换 + 同构映射
+alignas(16) uint8_t NIBBLE_OUT_LO[16], NIBBLE_OUT_HI[16];  // 逆同构映射 + 输出仿射变换
+alignas(16) uint8_t NIBBLE_SQ[16], NIBBLE_SQ_LAMBDA[16];   // n^2, λ·n^2
+alignas(16) uint8_t NIBBLE_LOG[16], NIBBLE_LOG_INV[16];    // log(n), log(n^-1)，零元素为负的哨兵值
+alignas(16) uint8_t NIBBLE_EXP[16];                        // 2^i
+
+// GF(2^n)乘法，poly包含最高次项
+uint8_t gf_multiply(uint8_t a, uint8_t b, unsigned poly, int bits) {
+    unsigned result = 0, x = a;
+    for (; b; b >>= 1) {
+        if (b & 1) result ^= x;
+        x <<= 1;
+        if (x >> bits) x ^= poly;
+    }
+    return static_cast<uint8_t>(result);
+}
+
+inline uint8_t gf16_multiply(uint8_t a, uint8_t b) {
+    return gf_multiply(a, b, 0x13, 4);
+}
+
+// 复合域乘法：(ah·y + al)(bh·y + bl)，y^2 = y + λ
+uint8_t tower_multiply(uint8_t a, uint8_t b) {
+    uint8_t ah = a >> 4, al = a & 0x0f, bh = b >> 4, bl = b & 0x0f;
+    uint8_t hh = gf16_multiply(ah, bh);
+    uint8_t high = hh ^ gf16_multiply(ah, bl) ^ gf16_multiply(al, bh);
+    uint8_t low = gf16_multiply(hh, TOWER_LAMBDA) ^ gf16_multiply(al, bl);
+    return static_cast<uint8_t>((high << 4) | low);
+}
+
+// SM4 S盒中的仿射变换 A·x + c
+uint8_t sm4_affine(uint8_t x, uint8_t c) {
+    uint8_t result = 0;
+    for (int i = 0; i < 8; ++i) {
+        uint8_t row = static_cast<uint8_t>((0xD3 >> i) | (0xD3 << (8 - i)));
+        uint8_t bits = row & x;
+        bits ^= bits >> 4; bits ^= bits >> 2; bits ^= bits >> 1;
+        result |= static_cast<uint8_t>((bits & 1) << (7 - i));
+    }
+    return result ^ c;
+}
+
+// 初始化复合域S盒用的各张4比特表
+void initialize_nibble_tables() {
+    // 取使 y^2+y+λ 在GF(2^4)上不可约的最小λ
+    for (TOWER_LAMBDA = 1; TOWER_LAMBDA < 16; ++TOWER_LAMBDA) {
+        bool has_root = false;
+        for (uint8_t z = 0; z < 16; ++z) {
+            has_root |= (gf16_multiply(z, z) ^ z ^ TOWER_LAMBDA) == 0;
+        }
+        if (!has_root) break;
+    }
+    
+    // 在复合域中找 f 的一个根β，x^i -> β^i 即为同构映射
+    uint8_t basis[8] = {1};
+    for (int beta = 2; beta < 256; ++beta) {
+        uint8_t power = 1, value = 0;
+        for (int i = 0; i <= 8; ++i) {
+            if ((0x1F5 >> i) & 1) value ^= power;
+            power = tower_multiply(power, static_cast<uint8_t>(beta));
+        }
+        if (value == 0) {
+            for (int i = 1; i < 8; ++i) basis[i] = tower_multiply(basis[i - 1], static_cast<uint8_t>(beta));
+            break;
+        }
+    }
+    uint8_t to_tower[256], from_tower[256];
+    for (int x = 0; x < 256; ++x) {
+        uint8_t y = 0;
+        for (int i = 0; i < 8; ++i) {
+            if ((x >> i) & 1) y ^= basis[i];
+        }
+        to_tower[x] = y;
+        from_tower[y] = static_cast<uint8_t>(x);
     }
+    
+    for (uint8_t n = 0; n < 16; ++n) {
+        NIBBLE_IN_LO[n] = to_tower[sm4_affine(n, 0xD3)];
+        NIBBLE_IN_HI[n] = to_tower[sm4_affine(static_cast<uint8_t>(n << 4), 0)];
+        NIBBLE_OUT_LO[n] = sm4_affine(from_tower[n], 0xD3);
+        NIBBLE_OUT_HI[n] = sm4_affine(from_tower[n << 4], 0);
+        NIBBLE_SQ[n] = gf16_multiply(n, n);
+        NIBBLE_SQ_LAMBDA[n] = gf16_multiply(NIBBLE_SQ[n], TOWER_LAMBDA);
+    }
+    
+    // 以2为生成元的对数表；零元素取0xC0，两个对数相加后仍为负数，pshufb结果为0
+    uint8_t power = 1;
+    for (uint8_t i = 0; i < 15; ++i) {
+        NIBBLE_EXP[i] = power;
+        NIBBLE_LOG[power] = i;
+        NIBBLE_LOG_INV[power] = static_cast<uint8_t>((15 - i) % 15);
+        power = gf16_multiply(power, 2);
+    }
+    NIBBLE_EXP[15] = 1;
+    NIBBLE_LOG[0] = NIBBLE_LOG_INV[0] = 0xC0;
 }
 
 // T函数查表实现
@@ -109,6 +221,195 @@ void generate_round_keys(const uint32_t key[4], uint32_t round_keys[32]) {
     memcpy(round_keys, &key_regs[4], 32 * sizeof(uint32_t));
 }
 
+#ifdef __AVX2__
+// 8通道32位循环左移
+inline __m256i mm256_left_rotate(__m256i value, int shift) {
+    return _mm256_or_si256(_mm256_slli_epi32(value, shift), _mm256_srli_epi32(value, 32 - shift));
+}
+
+// 8通道并行S盒：每个字节位置做一次gather
+inline __m256i mm256_sbox(__m256i input) {
+    const int* table = reinterpret_cast<const int*>(SM4_SUB_BOX32);
+    const __m256i mask = _mm256_set1_epi32(0xff);
+    __m256i b0 = _mm256_i32gather_epi32(table, _mm256_srli_epi32(input, 24), 4);
+    __m256i b1 = _mm256_i32gather_epi32(table, _mm256_and_si256(_mm256_srli_epi32(input, 16), mask), 4);
+    __m256i b2 = _mm256_i32gather_epi32(table, _mm256_and_si256(_mm256_srli_epi32(input, 8), mask), 4);
+    __m256i b3 = _mm256_i32gather_epi32(table, _mm256_and_si256(input, mask), 4);
+    return _mm256_or_si256(_mm256_or_si256(_mm256_slli_epi32(b0, 24), _mm256_slli_epi32(b1, 16)),
+                           _mm256_or_si256(_mm256_slli_epi32(b2, 8), b3));
+}
+
+// 8通道并行T'变换：S盒 + L'
+inline __m256i mm256_T_prime_transform(__m256i input) {
+    __m256i b = mm256_sbox(input);
+    return _mm256_xor_si256(_mm256_xor_si256(b, mm256_left_rotate(b, 13)), mm256_left_rotate(b, 23));
+}
+
+// 8通道并行T变换：四张T盒各做一次gather
+inline __m256i mm256_T_function(__m256i input) {
+    const __m256i mask = _mm256_set1_epi32(0xff);
+    __m256i t0 = _mm256_i32gather_epi32(reinterpret_cast<const int*>(T_BOX0), _mm256_srli_epi32(input, 24), 4);
+    __m256i t1 = _mm256_i32gather_epi32(reinterpret_cast<const int*>(T_BOX1),
+                                        _mm256_and_si256(_mm256_srli_epi32(input, 16), mask), 4);
+    __m256i t2 = _mm256_i32gather_epi32(reinterpret_cast<const int*>(T_BOX2),
+                                        _mm256_and_si256(_mm256_srli_epi32(input, 8), mask), 4);
+    __m256i t3 = _mm256_i32gather_epi32(reinterpret_cast<const int*>(T_BOX3), _mm256_and_si256(input, mask), 4);
+    return _mm256_xor_si256(_mm256_xor_si256(t0, t1), _mm256_xor_si256(t2, t3));
+}
+#endif
+
+#ifdef __SSSE3__
+// 常驻寄存器的4比特表
+struct NibbleTables {
+    __m128i in_lo, in_hi, out_lo, out_hi, sq, sq_lambda, log, log_inv, exp;
+};
+
+inline NibbleTables load_nibble_tables() {
+    auto load = [](const uint8_t table[16]) { return _mm_load_si128(reinterpret_cast<const __m128i*>(table)); };
+    return { load(NIBBLE_IN_LO), load(NIBBLE_IN_HI), load(NIBBLE_OUT_LO), load(NIBBLE_OUT_HI),
+             load(NIBBLE_SQ), load(NIBBLE_SQ_LAMBDA), load(NIBBLE_LOG), load(NIBBLE_LOG_INV), load(NIBBLE_EXP) };
+}
+
+// GF(2^4)乘法：对数相加，和 ≥ 15 时减15，再查指数表（零元素的哨兵值为负，不参与约减）
+inline __m128i gf16_multiply_log(__m128i log_a, __m128i log_b, const NibbleTables& t) {
+    __m128i sum = _mm_add_epi8(log_a, log_b);
+    __m128i wrap = _mm_and_si128(_mm_cmpgt_epi8(sum, _mm_set1_epi8(14)), _mm_set1_epi8(15));
+    return _mm_shuffle_epi8(t.exp, _mm_sub_epi8(sum, wrap));
+}
+
+// 16字节并行S盒，全程只用pshufb查寄存器中的表
+inline __m128i sm4_sbox_ssse3(__m128i x, const NibbleTables& t) {
+    const __m128i low4 = _mm_set1_epi8(0x0f);
+    
+    // 输入仿射变换并映射到复合域：v = h·y + l
+    __m128i v = _mm_xor_si128(_mm_shuffle_epi8(t.in_lo, _mm_and_si128(x, low4)),
+                              _mm_shuffle_epi8(t.in_hi, _mm_and_si128(_mm_srli_epi16(x, 4), low4)));
+    __m128i h = _mm_and_si128(_mm_srli_epi16(v, 4), low4);
+    __m128i l = _mm_and_si128(v, low4);
+    __m128i log_h = _mm_shuffle_epi8(t.log, h);
+    
+    // Δ = λh^2 + hl + l^2，(h·y + l)^-1 = (h·Δ^-1)·y + (h+l)·Δ^-1
+    __m128i delta = _mm_xor_si128(_mm_xor_si128(_mm_shuffle_epi8(t.sq_lambda, h), _mm_shuffle_epi8(t.sq, l)),
+                                  gf16_multiply_log(log_h, _mm_shuffle_epi8(t.log, l), t));
+    __m128i log_delta_inv = _mm_shuffle_epi8(t.log_inv, delta);
+    __m128i inv_h = gf16_multiply_log(log_h, log_delta_inv, t);
+    __m128i inv_l = gf16_multiply_log(_mm_shuffle_epi8(t.log, _mm_xor_si128(h, l)), log_delta_inv, t);
+    
+    // 映射回SM4的域并做输出仿射变换
+    return _mm_xor_si128(_mm_shuffle_epi8(t.out_lo, inv_l), _mm_shuffle_epi8(t.out_hi, inv_h));
+}
+
+// 4通道L变换：L(B) = B ^ (B<<<24) ^ ((B ^ (B<<<8) ^ (B<<<16)) <<< 2)，字节循环移位用pshufb
+inline __m128i sm4_linear_ssse3(__m128i b) {
+    const __m128i rot8 = _mm_setr_epi8(3, 0, 1, 2, 7, 4, 5, 6, 11, 8, 9, 10, 15, 12, 13, 14);
+    const __m128i rot16 = _mm_setr_epi8(2, 3, 0, 1, 6, 7, 4, 5, 10, 11, 8, 9, 14, 15, 12, 13);
+    const __m128i rot24 = _mm_setr_epi8(1, 2, 3, 0, 5, 6, 7, 4, 9, 10, 11, 8, 13, 14, 15, 12);
+    __m128i t = _mm_xor_si128(_mm_xor_si128(b, _mm_shuffle_epi8(b, rot8)), _mm_shuffle_epi8(b, rot16));
+    t = _mm_or_si128(_mm_slli_epi32(t, 2), _mm_srli_epi32(t, 30));
+    return _mm_xor_si128(_mm_xor_si128(b, _mm_shuffle_epi8(b, rot24)), t);
+}
+
+// 4x4字转置：4个分组 <-> 每个寄存器存放4个分组的同一个字
+inline void transpose4_epi32(__m128i& r0, __m128i& r1, __m128i& r2, __m128i& r3) {
+    __m128i t0 = _mm_unpacklo_epi32(r0, r1), t1 = _mm_unpackhi_epi32(r0, r1);
+    __m128i t2 = _mm_unpacklo_epi32(r2, r3), t3 = _mm_unpackhi_epi32(r2, r3);
+    r0 = _mm_unpacklo_epi64(t0, t2); r1 = _mm_unpackhi_epi64(t0, t2);
+    r2 = _mm_unpacklo_epi64(t1, t3); r3 = _mm_unpackhi_epi64(t1, t3);
+}
+
+// GROUPS组、每组4个分组交错执行32轮
+template <int GROUPS>
+void sm4_ssse3_crypt_groups(uint32_t (*output)[4], const uint32_t (*input)[4],
+                            const uint32_t round_keys[32], bool encrypt) {
+    const NibbleTables tables = load_nibble_tables();
+    __m128i x[GROUPS][4];
+    for (int g = 0; g < GROUPS; ++g) {
+        for (int j = 0; j < 4; ++j) {
+            x[g][j] = _mm_loadu_si128(reinterpret_cast<const __m128i*>(input[g * 4 + j]));
+        }
+        transpose4_epi32(x[g][0], x[g][1], x[g][2], x[g][3]);
+    }
+    
+    for (int i = 0; i < 32; ++i) {
+        __m128i rk = _mm_set1_epi32(static_cast<int>(round_keys[encrypt ? i : 31 - i]));
+        for (int g = 0; g < GROUPS; ++g) {
+            __m128i t = _mm_xor_si128(_mm_xor_si128(x[g][1], x[g][2]), _mm_xor_si128(x[g][3], rk));
+            __m128i next = _mm_xor_si128(x[g][0], sm4_linear_ssse3(sm4_sbox_ssse3(t, tables)));
+            x[g][0] = x[g][1]; x[g][1] = x[g][2]; x[g][2] = x[g][3]; x[g][3] = next;
+        }
+    }
+    
+    // 反序输出
+    for (int g = 0; g < GROUPS; ++g) {
+        transpose4_epi32(x[g][3], x[g][2], x[g][1], x[g][0]);
+        for (int j = 0; j < 4; ++j) {
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(output[g * 4 + j]), x[g][3 - j]);
+        }
+    }
+}
+#endif
+
+// 轮密钥转置：8把密钥各自连续的布局 -> 按轮存放（rk_soa[轮][通道]）
+void transpose_round_keys_x8(const uint32_t round_keys[8][32], uint32_t rk_soa[32][8]) {
+    for (int i = 0; i < 32; ++i) {
+        for (int b = 0; b < 8; ++b) {
+            rk_soa[i][b] = round_keys[b][i];
+        }
+    }
+}
+
+// 批量密钥扩展，直接输出按轮存放的轮密钥（多密钥内核使用的布局）
+void generate_round_keys_x8_soa(const uint32_t keys[8][4], uint32_t rk_soa[32][8]) {
+#ifdef __AVX2__
+    __m256i k[4];
+    for (int i = 0; i < 4; ++i) {
+        k[i] = _mm256_xor_si256(
+            _mm256_setr_epi32(keys[0][i], keys[1][i], keys[2][i], keys[3][i],
+                              keys[4][i], keys[5][i], keys[6][i], keys[7][i]),
+            _mm256_set1_epi32(SYS_PARAMS[i]));
+    }
+    
+    // 32轮并行计算
+    for (int i = 0; i < 32; ++i) {
+        __m256i t = _mm256_xor_si256(_mm256_xor_si256(k[1], k[2]),
+                                     _mm256_xor_si256(k[3], _mm256_set1_epi32(ROUND_KEY_PARAMS[i])));
+        __m256i next = _mm256_xor_si256(k[0], mm256_T_prime_transform(t));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(rk_soa[i]), next);
+        k[0] = k[1]; k[1] = k[2]; k[2] = k[3]; k[3] = next;
+    }
+#else
+    uint32_t round_keys[8][32];
+    for (int b = 0; b < 8; ++b) {
+        generate_round_keys(keys[b], round_keys[b]);
+    }
+    transpose_round_keys_x8(round_keys, rk_soa);
+#endif
+}
+
+// 批量密钥扩展（一次8把密钥，每把密钥占一个32位通道）
+void generate_round_keys_x8(const uint32_t keys[8][4], uint32_t round_keys[8][32]) {
+    uint32_t rk_soa[32][8];
+    generate_round_keys_x8_soa(keys, rk_soa);
+    
+    // 转回每把密钥连续存放的布局
+    for (int i = 0; i < 32; ++i) {
+        for (int b = 0; b < 8; ++b) {
+            round_keys[b][i] = rk_soa[i][b];
+        }
+    }
+}
+
+// 批量密钥扩展：按8把一组并行，剩余不足8把的逐个处理
+void generate_round_keys_batch(const uint32_t (*keys)[4], uint32_t (*round_keys)[32], size_t count) {
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        generate_round_keys_x8(keys + i, round_keys + i);
+    }
+    for (; i < count; ++i) {
+        generate_round_keys(keys[i], round_keys[i]);
+    }
+}
+
 // SM4加解密核心函数
 void sm4_process_block(uint32_t block[4], const uint32_t round_keys[32], bool encrypt = true) {
     uint32_t state[36];
@@ -154,6 +455,58 @@ void sm4_simd_encrypt4(uint32_t output[4][4], const uint32_t input[4][4], const
     }
 }
 
+// 多密钥并行加解密：8个分组各用自己的密钥，rk_soa[轮][通道]为转置后的轮密钥
+// 内核在SM4-Core.h（SM4_Core::crypt_words8_multikey，卸载服务共用），这里只做分组与按字布局的转换
+void sm4_multikey_crypt8(uint32_t output[8][4], const uint32_t input[8][4],
+                         const uint32_t rk_soa[32][8], bool encrypt = true) {
+    uint32_t x[4][8];
+    for (int b = 0; b < 8; ++b) {
+        for (int j = 0; j < 4; ++j) {
+            x[j][b] = input[b][j];
+        }
+    }
+    SM4_Core::crypt_words8_multikey(x, rk_soa, encrypt);
+    for (int b = 0; b < 8; ++b) {
+        for (int j = 0; j < 4; ++j) {
+            output[b][j] = x[j][b];
+        }
+    }
+}
+
+// 是否编译进了常数时间内核。未开启SSSE3（-mssse3或-march=native）时下面两个函数退回查表实现，
+// 结果相同但访存依赖数据，不是常数时间的
+#ifdef __SSSE3__
+constexpr bool SSSE3_CONSTANT_TIME = true;
+#else
+constexpr bool SSSE3_CONSTANT_TIME = false;
+#endif
+
+// SSSE3常数时间加解密（一次4个分组）：S盒在寄存器内计算，不访问S盒/T盒；见SSSE3_CONSTANT_TIME
+void sm4_ssse3_crypt4(uint32_t output[4][4], const uint32_t input[4][4],
+                      const uint32_t round_keys[32], bool encrypt = true) {
+#ifdef __SSSE3__
+    sm4_ssse3_crypt_groups<1>(output, input, round_keys, encrypt);
+#else
+    for (int b = 0; b < 4; ++b) {
+        memcpy(output[b], input[b], 4 * sizeof(uint32_t));
+        sm4_process_block(output[b], round_keys, encrypt);
+    }
+#endif
+}
+
+// SSSE3常数时间加解密（一次8个分组，两组交错以填满流水线）；见SSSE3_CONSTANT_TIME
+void sm4_ssse3_crypt8(uint32_t output[8][4], const uint32_t input[8][4],
+                      const uint32_t round_keys[32], bool encrypt = true) {
+#ifdef __SSSE3__
+    sm4_ssse3_crypt_groups<2>(output, input, round_keys, encrypt);
+#else
+    for (int b = 0; b < 8; ++b) {
+        memcpy(output[b], input[b], 4 * sizeof(uint32_t));
+        sm4_process_block(output[b], round_keys, encrypt);
+    }
+#endif
+}
+
 // 打印数据块
 void display_block(const string& title, const uint32_t block[4]) {
     cout << title << ": ";
@@ -228,6 +581,218 @@ void verify_simd_function() {
     cout << "[SIMD正确性测试] " << (result_match ? "通过" : "失败") << endl;
 }
 
+// 批量密钥扩展正确性测试
+void verify_batch_key_schedule() {
+    const size_t KEY_COUNT = 19;  // 两组8把 + 3把剩余
+    uint32_t keys[KEY_COUNT][4], batch_keys[KEY_COUNT][32], normal_keys[KEY_COUNT][32];
+    
+    mt19937 gen(2024);
+    for (size_t b = 0; b < KEY_COUNT; ++b) {
+        for (int i = 0; i < 4; ++i) {
+            keys[b][i] = gen();
+        }
+    }
+    
+    generate_round_keys_batch(keys, batch_keys, KEY_COUNT);
+    for (size_t b = 0; b < KEY_COUNT; ++b) {
+        generate_round_keys(keys[b], normal_keys[b]);
+    }
+    
+    bool result_match = memcmp(batch_keys, normal_keys, sizeof(batch_keys)) == 0;
+    cout << "[批量密钥扩展正确性测试] " << (result_match ? "通过" : "失败") << endl;
+}
+
+// 批量密钥扩展性能测试
+void test_batch_key_schedule_performance() {
+    const int TEST_COUNT = 200000;
+    uint32_t keys[8][4], round_keys[8][32];
+    for (int b = 0; b < 8; ++b) {
+        for (int i = 0; i < 4; ++i) {
+            keys[b][i] = 0x01010101 * (b + 1) + i;
+        }
+    }
+    
+    auto start = chrono::high_resolution_clock::now();
+    for (int n = 0; n < TEST_COUNT; ++n) {
+        for (int b = 0; b < 8; ++b) {
+            generate_round_keys(keys[b], round_keys[b]);
+        }
+        keys[0][0] ^= round_keys[7][31];
+    }
+    auto mid = chrono::high_resolution_clock::now();
+    for (int n = 0; n < TEST_COUNT; ++n) {
+        generate_round_keys_x8(keys, round_keys);
+        keys[0][0] ^= round_keys[7][31];
+    }
+    auto end = chrono::high_resolution_clock::now();
+    
+    chrono::duration<double> normal_time = mid - start;
+    chrono::duration<double> batch_time = end - mid;
+    
+    cout << "\n[批量密钥扩展性能测试]\n";
+    cout << "逐个扩展: " << (TEST_COUNT * 8 / normal_time.count()) << " 密钥/秒\n";
+    cout << "批量扩展: " << (TEST_COUNT * 8 / batch_time.count()) << " 密钥/秒\n";
+}
+
+// 多密钥内核正确性测试
+void verify_multikey_function() {
+    uint32_t keys[8][4], rk_soa[32][8], round_keys[8][32];
+    uint32_t test_inputs[8][4], multikey_output[8][4], normal_output[8][4], decrypted[8][4];
+    
+    mt19937 gen(2025);
+    for (int b = 0; b < 8; ++b) {
+        for (int i = 0; i < 4; ++i) {
+            keys[b][i] = gen();
+            test_inputs[b][i] = gen();
+        }
+    }
+    
+    generate_round_keys_x8_soa(keys, rk_soa);
+    sm4_multikey_crypt8(multikey_output, test_inputs, rk_soa, true);
+    sm4_multikey_crypt8(decrypted, multikey_output, rk_soa, false);
+    
+    // 普通加密（作为对照）
+    for (int b = 0; b < 8; ++b) {
+        generate_round_keys(keys[b], round_keys[b]);
+        memcpy(normal_output[b], test_inputs[b], sizeof(normal_output[b]));
+        sm4_process_block(normal_output[b], round_keys[b], true);
+    }
+    
+    // 单独扩展后再转置，结果应与批量扩展一致
+    uint32_t transposed[32][8];
+    transpose_round_keys_x8(round_keys, transposed);
+    
+    bool result_match = memcmp(multikey_output, normal_output, sizeof(normal_output)) == 0 &&
+                        memcmp(decrypted, test_inputs, sizeof(test_inputs)) == 0 &&
+                        memcmp(transposed, rk_soa, sizeof(rk_soa)) == 0;
+    cout << "[多密钥内核正确性测试] " << (result_match ? "通过" : "失败") << endl;
+}
+
+// 多密钥内核性能测试
+void test_multikey_performance() {
+    const int TEST_COUNT = 500000;
+    uint32_t keys[8][4], round_keys[8][32], rk_soa[32][8];
+    uint32_t blocks[8][4], output[8][4];
+    for (int b = 0; b < 8; ++b) {
+        for (int i = 0; i < 4; ++i) {
+            keys[b][i] = 0x01010101 * (b + 1) + i;
+            blocks[b][i] = 0x10101010 * (i + 1) + b;
+        }
+        generate_round_keys(keys[b], round_keys[b]);
+    }
+    generate_round_keys_x8_soa(keys, rk_soa);
+    
+    auto start = chrono::high_resolution_clock::now();
+    for (int n = 0; n < TEST_COUNT; ++n) {
+        for (int b = 0; b < 8; ++b) {
+            sm4_process_block(blocks[b], round_keys[b], true);
+        }
+    }
+    auto mid = chrono::high_resolution_clock::now();
+    for (int n = 0; n < TEST_COUNT; ++n) {
+        sm4_multikey_crypt8(output, blocks, rk_soa, true);
+        blocks[0][0] ^= output[7][3];
+    }
+    auto end = chrono::high_resolution_clock::now();
+    
+    chrono::duration<double> normal_time = mid - start;
+    chrono::duration<double> multikey_time = end - mid;
+    
+    cout << "\n[多密钥内核性能测试]\n";
+    cout << "逐块加密: " << (TEST_COUNT * 8 / normal_time.count()) << " 分组/秒\n";
+    cout << "多密钥并行: " << (TEST_COUNT * 8 / multikey_time.count()) << " 分组/秒\n";
+}
+
+// SSSE3内核正确性测试
+void verify_ssse3_function() {
+    bool result_match = true;
+    if (!SSSE3_CONSTANT_TIME) {
+        cout << "[SSSE3内核正确性测试] 未用-mssse3编译，常数时间内核未编入，以下只检查查表回退路径\n";
+    }
+    
+#ifdef __SSSE3__
+    // S盒穷举比对
+    const NibbleTables tables = load_nibble_tables();
+    for (int base = 0; base < 256; base += 16) {
+        alignas(16) uint8_t bytes[16];
+        for (int i = 0; i < 16; ++i) bytes[i] = static_cast<uint8_t>(base + i);
+        __m128i out = sm4_sbox_ssse3(_mm_load_si128(reinterpret_cast<const __m128i*>(bytes)), tables);
+        _mm_store_si128(reinterpret_cast<__m128i*>(bytes), out);
+        for (int i = 0; i < 16; ++i) {
+            result_match &= bytes[i] == SM4_SUB_BOX[base + i];
+        }
+    }
+#endif
+    
+    uint32_t round_keys[32];
+    uint32_t secret_key[4] = {0x01234567, 0x89abcdef, 0xfedcba98, 0x76543210};
+    generate_round_keys(secret_key, round_keys);
+    
+    uint32_t test_inputs[8][4], ssse3_output[8][4], normal_output[8][4], decrypted[8][4];
+    mt19937 gen(2026);
+    for (int b = 0; b < 8; ++b) {
+        for (int i = 0; i < 4; ++i) {
+            test_inputs[b][i] = gen();
+        }
+        memcpy(normal_output[b], test_inputs[b], sizeof(normal_output[b]));
+        sm4_process_block(normal_output[b], round_keys, true);
+    }
+    
+    sm4_ssse3_crypt8(ssse3_output, test_inputs, round_keys, true);
+    sm4_ssse3_crypt8(decrypted, ssse3_output, round_keys, false);
+    result_match &= memcmp(ssse3_output, normal_output, sizeof(normal_output)) == 0;
+    result_match &= memcmp(decrypted, test_inputs, sizeof(test_inputs)) == 0;
+    
+    sm4_ssse3_crypt4(ssse3_output, test_inputs, round_keys, true);
+    result_match &= memcmp(ssse3_output, normal_output, 4 * sizeof(normal_output[0])) == 0;
+    
+    // GM/T 0002-2012 附录A 标准测试向量
+    const uint32_t expected[4] = {0x681edf34, 0xd206965e, 0x86b3e94f, 0x536e4246};
+    for (int b = 0; b < 4; ++b) {
+        memcpy(test_inputs[b], secret_key, sizeof(secret_key));
+    }
+    sm4_ssse3_crypt4(ssse3_output, test_inputs, round_keys, true);
+    for (int b = 0; b < 4; ++b) {
+        result_match &= memcmp(ssse3_output[b], expected, sizeof(expected)) == 0;
+    }
+    
+    cout << "[SSSE3内核正确性测试] " << (result_match ? "通过" : "失败") << endl;
+}
+
+// SSSE3内核性能测试
+void test_ssse3_performance() {
+    const int TEST_COUNT = 500000;
+    uint32_t round_keys[32];
+    uint32_t secret_key[4] = {0x01234567, 0x89abcdef, 0xfedcba98, 0x76543210};
+    generate_round_keys(secret_key, round_keys);
+    
+    uint32_t blocks[8][4], output[8][4];
+    for (int b = 0; b < 8; ++b) {
+        for (int i = 0; i < 4; ++i) {
+            blocks[b][i] = 0x01010101 * (b + 1) + i;
+        }
+    }
+    
+    auto start = chrono::high_resolution_clock::now();
+    for (int n = 0; n < TEST_COUNT; ++n) {
+        sm4_ssse3_crypt4(output, blocks, round_keys);
+        blocks[0][0] ^= output[3][3];
+    }
+    auto mid = chrono::high_resolution_clock::now();
+    for (int n = 0; n < TEST_COUNT; ++n) {
+        sm4_ssse3_crypt8(output, blocks, round_keys);
+        blocks[0][0] ^= output[7][3];
+    }
+    auto end = chrono::high_resolution_clock::now();
+    
+    chrono::duration<double> time4 = mid - start;
+    chrono::duration<double> time8 = end - mid;
+    
+    cout << "\n[SSSE3内核性能测试]" << (SSSE3_CONSTANT_TIME ? "" : "（查表回退，非常数时间）") << "\n";
+    cout << "4分组: " << (TEST_COUNT * 4 / time4.count()) << " 分组/秒\n";
+    cout << "8分组: " << (TEST_COUNT * 8 / time8.count()) << " 分组/秒\n";
+}
+
 // SIMD性能测试
 void test_simd_performance() {
     const int TEST_COUNT = 1000000;
@@ -238,4 +803,43 @@ void test_simd_performance() {
     // 测试数据
     uint32_t test_blocks[4][4] = {
         {0x00112233, 0x44556677, 0x8899aabb, 0xccddeeff},
-        {0x01234567, 0x89abcdef, 0xfedcba98,
\ No newline at end of file
+        {0x01234567, 0x89abcdef, 0xfedcba98, 0x76543210},
+        {0x11223344, 0x55667788, 0x99aabbcc, 0xddeeff00},
+        {0x0f1e2d3c, 0x4b5a6978, 0x8796a5b4, 0xc3d2e1f0}
+    };
+    uint32_t output_blocks[4][4];
+    
+    auto start = chrono::high_resolution_clock::now();
+    for (int i = 0; i < TEST_COUNT; ++i) {
+        sm4_simd_encrypt4(output_blocks, test_blocks, round_keys);
+        test_blocks[0][0] ^= output_blocks[3][3];
+    }
+    auto end = chrono::high_resolution_clock::now();
+    
+    chrono::duration<double> elapsed = end - start;
+    
+    cout << "\n[SIMD性能测试]\n";
+    cout << "处理 " << TEST_COUNT * 4 << " 个分组，耗时 " << elapsed.count() << " 秒\n";
+    cout << "吞吐量: " << (TEST_COUNT * 4 / elapsed.count()) << " 分组/秒\n";
+}
+
+int main() {
+    initialize_tbox();
+    initialize_nibble_tables();
+    
+    cout << "[基础正确性测试]" << endl;
+    verify_basic_function();
+    
+    verify_simd_function();
+    test_simd_performance();
+    
+    verify_batch_key_schedule();
+    test_batch_key_schedule_performance();
+    
+    verify_multikey_function();
+    test_multikey_performance();
+    
+    verify_ssse3_function();
+    test_ssse3_performance();
+    return 0;
+}
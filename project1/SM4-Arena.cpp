@@ -0,0 +1,121 @@
+#include <iostream>
+#include <vector>
+#include <thread>
+#include <chrono>
+#include <random>
+#include "SM4-Arena.h"
+#include "SM4-GCM.h"
+using namespace std;
+
+// --- 测试 ---
+
+bool all_zero(const uint8_t* p, size_t n) {
+    for (size_t i = 0; i < n; ++i)
+        if (p[i]) return false;
+    return true;
+}
+
+// 对齐、分配即清零、释放后清零复用、大块单独映射
+void test_arena_correctness() {
+    cout << "=== Secure Arena Test ===\n";
+    SecureArena& arena = SecureArena::global();
+    bool ok = true;
+    for (size_t n : { 0, 1, 64, 65, 1000, 4096, 65536, 100000, 1 << 20, (1 << 20) + 1, 5 << 20 }) {
+        uint8_t* p = static_cast<uint8_t*>(arena.allocate(n));
+        ok = ok && reinterpret_cast<uintptr_t>(p) % SecureArena::ALIGNMENT == 0 && all_zero(p, n);
+        memset(p, 0xa5, n);
+        arena.deallocate(p, n);
+        // 同一大小类的下一次分配复用刚释放的块，内容已清零
+        uint8_t* q = static_cast<uint8_t*>(arena.allocate(n));
+        ok = ok && (n > SecureArena::MAX_CLASS_BYTES || q == p) && all_zero(q, n);
+        arena.deallocate(q, n);
+    }
+    cout << "Alignment / zero-on-allocate / reuse " << (ok ? "Passed" : "Failed") << endl;
+
+    // 在一个线程分配、另一个线程释放，线程退出后块回到全局链表
+    vector<void*> blocks;
+    thread producer([&] {
+        for (int i = 0; i < 1000; ++i) blocks.push_back(arena.allocate(512));
+    });
+    producer.join();
+    thread consumer([&] {
+        for (void* p : blocks) arena.deallocate(p, 512);
+    });
+    consumer.join();
+    bool cross = true;
+    vector<void*> again;
+    for (int i = 0; i < 1000; ++i) {
+        again.push_back(arena.allocate(512));
+        cross = cross && all_zero(static_cast<uint8_t*>(again.back()), 512);
+    }
+    for (void* p : again) arena.deallocate(p, 512);
+    cout << "Cross-thread free " << (cross ? "Passed" : "Failed") << endl;
+
+    // 多线程混合大小分配释放
+    bool stress = true;
+    mutex stress_mutex;
+    vector<thread> threads;
+    for (int t = 0; t < 4; ++t) {
+        threads.emplace_back([&, t] {
+            mt19937 rng(t);
+            vector<pair<uint8_t*, size_t>> live;
+            bool local = true;
+            for (int i = 0; i < 20000; ++i) {
+                if (live.size() < 64 && (rng() & 1)) {
+                    size_t n = 1 + rng() % 20000;
+                    uint8_t* p = static_cast<uint8_t*>(arena.allocate(n));
+                    local = local && p[0] == 0 && p[n - 1] == 0;
+                    memset(p, t + 1, n);
+                    live.emplace_back(p, n);
+                } else if (!live.empty()) {
+                    size_t k = rng() % live.size();
+                    local = local && live[k].first[0] == t + 1 && live[k].first[live[k].second - 1] == t + 1;
+                    arena.deallocate(live[k].first, live[k].second);
+                    live[k] = live.back();
+                    live.pop_back();
+                }
+            }
+            for (auto& block : live) arena.deallocate(block.first, block.second);
+            lock_guard<mutex> lock(stress_mutex);
+            stress = stress && local;
+        });
+    }
+    for (thread& t : threads) t.join();
+    cout << "Concurrent allocate/free (4 threads) " << (stress ? "Passed" : "Failed") << endl;
+
+    SecureArena::Stats stats = arena.stats();
+    cout << "Regions: " << stats.regions << " (huge pages: " << stats.huge_regions << "), locked: "
+         << stats.locked_bytes / 1024 << " KB, not locked: " << stats.unlocked_bytes / 1024
+         << " KB, large: " << stats.large_bytes << " bytes\n";
+}
+
+// 批量调用的典型模式：每次调用临时分配工作缓冲区
+template <typename Buffer>
+double bulk_calls(size_t size, int calls) {
+    uint8_t key[16] = { 1 }, iv[12] = { 2 }, tag[16];
+    GcmKey ctx;
+    gcm_key_init(ctx, key);
+    auto start = chrono::high_resolution_clock::now();
+    for (int i = 0; i < calls; ++i) {
+        Buffer in(size, static_cast<uint8_t>(i)), out(size);
+        sm4_gcm_encrypt(ctx, iv, in.data(), size, nullptr, 0, out.data(), tag);
+    }
+    return chrono::duration<double>(chrono::high_resolution_clock::now() - start).count();
+}
+
+void test_arena_performance() {
+    cout << "=== Per-Call Buffer Allocation Test ===\n";
+    for (size_t size : { 256, 4096, 65536, 1 << 20 }) {
+        int calls = static_cast<int>((64 << 20) / size);
+        double heap = bulk_calls<vector<uint8_t>>(size, calls);
+        double pooled = bulk_calls<secure_vector<uint8_t>>(size, calls);
+        cout << size << " bytes x " << calls << " calls: std::vector " << heap * 1000 << " ms, secure_vector "
+             << pooled * 1000 << " ms\n";
+    }
+}
+
+int main() {
+    test_arena_correctness();
+    test_arena_performance();
+    return 0;
+}
@@ -0,0 +1,311 @@
+#pragma once
+
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <utility>
+#include <vector>
+#ifdef __linux__
+#include <sys/mman.h>
+#endif
+
+// 存放密钥和加解密工作缓冲区的安全内存池
+// - 从2MB区域（优先大页，Linux上mlock锁定、不写入core dump）按64字节对齐切出大小类（64B~1MB，2的幂）
+// - 释放时先清零，再放入本线程的空闲链表，下次同一大小类的分配直接复用，热路径上没有锁和堆操作；
+//   线程本地链表过长时成批归还全局链表，线程退出时全部归还
+// - 分配得到的内存总是全零（新区域由内核清零，复用的块释放时已清零）
+// - 超过1MB的请求单独映射，释放时清零并解除映射
+// 非Linux平台退化为按64字节对齐的operator new，不锁定内存
+class SecureArena {
+public:
+    static constexpr size_t ALIGNMENT = 64;
+    static constexpr size_t REGION_BYTES = 2 << 20;
+    static constexpr size_t MIN_CLASS_BYTES = 64;
+    static constexpr size_t MAX_CLASS_BYTES = 1 << 20;
+    static constexpr size_t CLASS_COUNT = 15;   // 64 << 0 ... 64 << 14
+    static constexpr size_t THREAD_CACHE_BLOCKS = 256;        // 每个大小类在线程本地最多缓存的块数
+    static constexpr size_t THREAD_CACHE_BYTES = 256 << 10;   // 及字节数（至少2块）
+
+    struct Stats {
+        size_t regions;         // 已映射的2MB区域数
+        size_t huge_regions;    // 其中由大页提供的区域数
+        size_t locked_bytes;    // 成功mlock的字节数（受RLIMIT_MEMLOCK限制）
+        size_t unlocked_bytes;  // mlock失败、可能被换出到交换区的字节数
+        size_t large_bytes;     // 单独映射的大块字节数
+    };
+
+    static SecureArena& global() {
+        // 不析构：其他线程退出时线程本地链表还要归还到这里
+        static SecureArena* arena = new SecureArena;
+        return *arena;
+    }
+
+    // n为0时也返回一个有效的最小块；内存不足时抛出std::bad_alloc
+    void* allocate(size_t n) {
+        if (n > MAX_CLASS_BYTES) return allocate_large(n);
+        size_t c = size_class(n);
+        ThreadCache* cache = thread_cache();
+        if (!cache) return allocate_shared(c);
+        std::vector<void*>& list = cache->lists[c];
+        if (list.empty()) refill(list, c);
+        void* p = list.back();
+        list.pop_back();
+        return p;
+    }
+
+    // n须与allocate时相同
+    void deallocate(void* p, size_t n) noexcept {
+        if (!p) return;
+        if (n > MAX_CLASS_BYTES) {
+            deallocate_large(p, n);
+            return;
+        }
+        size_t c = size_class(n);
+        wipe(p, class_bytes(c));
+        ThreadCache* cache = thread_cache();
+        if (cache && cache->lists[c].capacity() == 0) {
+            try {
+                cache->lists[c].reserve(cache_limit(c) + 1);
+            } catch (...) {
+            }
+        }
+        if (!cache || cache->lists[c].size() == cache->lists[c].capacity()) {
+            std::lock_guard<std::mutex> lock(mutex_);
+            free_lists_[c].push_back(p);   // 已预留容量，见refill
+            return;
+        }
+        std::vector<void*>& list = cache->lists[c];
+        list.push_back(p);
+        if (list.size() > cache_limit(c)) {
+            // 归还一半，保留一半供后续分配
+            std::lock_guard<std::mutex> lock(mutex_);
+            size_t keep = list.size() / 2;
+            free_lists_[c].insert(free_lists_[c].end(), list.begin() + keep, list.end());
+            list.resize(keep);
+        }
+    }
+
+    Stats stats() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return stats_;
+    }
+
+    // 清零不会被编译器当作死存储删除
+    static void wipe(void* p, size_t n) noexcept {
+#if defined(__GNUC__)
+        memset(p, 0, n);
+        __asm__ __volatile__("" : : "r"(p) : "memory");
+#else
+        volatile uint8_t* v = static_cast<volatile uint8_t*>(p);
+        for (size_t i = 0; i < n; ++i) v[i] = 0;
+#endif
+    }
+
+    static size_t size_class(size_t n) {
+        size_t c = 0;
+        while ((MIN_CLASS_BYTES << c) < n) ++c;
+        return c;
+    }
+
+    static size_t class_bytes(size_t c) {
+        return MIN_CLASS_BYTES << c;
+    }
+
+    SecureArena(const SecureArena&) = delete;
+    SecureArena& operator=(const SecureArena&) = delete;
+
+private:
+    struct ThreadCache {
+        std::vector<void*> lists[CLASS_COUNT];
+
+        ~ThreadCache() {
+            cache_destroyed_ = true;
+            SecureArena& arena = SecureArena::global();
+            std::lock_guard<std::mutex> lock(arena.mutex_);
+            for (size_t c = 0; c < CLASS_COUNT; ++c) {
+                arena.free_lists_[c].insert(arena.free_lists_[c].end(), lists[c].begin(), lists[c].end());
+            }
+        }
+    };
+
+    mutable std::mutex mutex_;
+    std::vector<void*> free_lists_[CLASS_COUNT];
+    uint8_t* region_ = nullptr;       // 当前切分中的区域
+    size_t region_used_ = 0;
+    size_t carved_[CLASS_COUNT] = {};  // 每个大小类已切出的块数
+    Stats stats_ = {};
+
+    SecureArena() = default;
+
+    inline static thread_local bool cache_destroyed_ = false;
+
+    // 线程退出过程中（本线程的ThreadCache已析构）返回nullptr，此时直接使用全局链表
+    static ThreadCache* thread_cache() {
+        if (cache_destroyed_) return nullptr;
+        static thread_local ThreadCache cache;
+        return &cache;
+    }
+
+    void* allocate_shared(size_t c) {
+        std::vector<void*> one;
+        one.reserve(cache_limit(c) + 1);
+        refill(one, c);
+        void* p = one.back();
+        one.pop_back();
+        std::lock_guard<std::mutex> lock(mutex_);
+        free_lists_[c].insert(free_lists_[c].end(), one.begin(), one.end());
+        return p;
+    }
+
+    static size_t cache_limit(size_t c) {
+        size_t limit = THREAD_CACHE_BYTES / class_bytes(c);
+        if (limit > THREAD_CACHE_BLOCKS) limit = THREAD_CACHE_BLOCKS;
+        return limit < 2 ? 2 : limit;
+    }
+
+    // 从全局链表取一批；全局链表为空时从区域切分新块
+    void refill(std::vector<void*>& list, size_t c) {
+        size_t batch = cache_limit(c) / 2;
+        std::lock_guard<std::mutex> lock(mutex_);
+        std::vector<void*>& global = free_lists_[c];
+        if (global.empty()) {
+            size_t bytes = class_bytes(c);
+            for (size_t i = 0; i < batch; ++i) {
+                if (!region_ || region_used_ + bytes > REGION_BYTES) {
+                    if (i > 0) break;   // 至少切出一块即可，避免为一批块新开区域
+                    bool huge = false;
+                    region_ = map_region(REGION_BYTES, huge);
+                    region_used_ = 0;
+                    ++stats_.regions;
+                    if (huge) ++stats_.huge_regions;
+                }
+                global.push_back(region_ + region_used_);
+                region_used_ += bytes;
+                ++carved_[c];
+            }
+            // 全局链表容量不小于已切出的块数，线程归还时不会再分配内存
+            global.reserve(carved_[c]);
+        }
+        size_t take = global.size() < batch ? global.size() : batch;
+        list.reserve(cache_limit(c) + 1);
+        list.insert(list.end(), global.end() - take, global.end());
+        global.resize(global.size() - take);
+    }
+
+    // 调用方持有mutex_
+    uint8_t* map_region(size_t bytes, bool& huge) {
+#ifdef __linux__
+        void* p = mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+        huge = p != MAP_FAILED;
+        if (!huge) {
+            // 没有预留大页时映射两倍大小，裁出按2MB对齐的部分，交给透明大页
+            size_t span = bytes + REGION_BYTES;
+            uint8_t* raw = static_cast<uint8_t*>(mmap(nullptr, span, PROT_READ | PROT_WRITE,
+                                                      MAP_PRIVATE | MAP_ANONYMOUS, -1, 0));
+            if (raw == MAP_FAILED) throw std::bad_alloc();
+            uintptr_t base = (reinterpret_cast<uintptr_t>(raw) + REGION_BYTES - 1) & ~(uintptr_t)(REGION_BYTES - 1);
+            uint8_t* aligned = reinterpret_cast<uint8_t*>(base);
+            if (aligned > raw) munmap(raw, aligned - raw);
+            if (aligned + bytes < raw + span) munmap(aligned + bytes, raw + span - (aligned + bytes));
+            p = aligned;
+            madvise(p, bytes, MADV_HUGEPAGE);
+        }
+        madvise(p, bytes, MADV_DONTDUMP);
+        if (mlock(p, bytes) == 0) {
+            stats_.locked_bytes += bytes;
+        } else {
+            // 超出RLIMIT_MEMLOCK时仍然可用，但其中的密钥可能被换出：第一次失败时提示一次
+            if (stats_.unlocked_bytes == 0) {
+                fprintf(stderr, "SecureArena: mlock failed after %zu locked bytes (%s); "
+                                "key memory beyond RLIMIT_MEMLOCK may be swapped out\n",
+                        stats_.locked_bytes, strerror(errno));
+            }
+            stats_.unlocked_bytes += bytes;
+        }
+        return static_cast<uint8_t*>(p);
+#else
+        huge = false;
+        return static_cast<uint8_t*>(::operator new(bytes, std::align_val_t(REGION_BYTES)));
+#endif
+    }
+
+    static size_t large_bytes(size_t n) {
+        return (n + REGION_BYTES - 1) / REGION_BYTES * REGION_BYTES;
+    }
+
+    void* allocate_large(size_t n) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        bool huge = false;
+        uint8_t* p = map_region(large_bytes(n), huge);
+        stats_.large_bytes += large_bytes(n);
+        return p;
+    }
+
+    void deallocate_large(void* p, size_t n) noexcept {
+        size_t bytes = large_bytes(n);
+        wipe(p, n);
+        std::lock_guard<std::mutex> lock(mutex_);
+        stats_.large_bytes -= bytes;
+#ifdef __linux__
+        if (munlock(p, bytes) == 0 && stats_.locked_bytes >= bytes) stats_.locked_bytes -= bytes;
+        munmap(p, bytes);
+#else
+        ::operator delete(p, std::align_val_t(REGION_BYTES));
+#endif
+    }
+};
+
+// 从SecureArena分配的STL分配器，如 std::vector<uint8_t, SecureAllocator<uint8_t>>
+template <typename T>
+struct SecureAllocator {
+    using value_type = T;
+
+    SecureAllocator() = default;
+    template <typename U>
+    SecureAllocator(const SecureAllocator<U>&) noexcept {}
+
+    T* allocate(size_t n) {
+        return static_cast<T*>(SecureArena::global().allocate(n * sizeof(T)));
+    }
+
+    void deallocate(T* p, size_t n) noexcept {
+        SecureArena::global().deallocate(p, n * sizeof(T));
+    }
+
+    template <typename U>
+    bool operator==(const SecureAllocator<U>&) const noexcept { return true; }
+    template <typename U>
+    bool operator!=(const SecureAllocator<U>&) const noexcept { return false; }
+};
+
+template <typename T>
+using secure_vector = std::vector<T, SecureAllocator<T>>;
+
+// 单个对象：析构后整块清零归还
+template <typename T>
+struct SecureDelete {
+    void operator()(T* p) const noexcept {
+        p->~T();
+        SecureArena::global().deallocate(p, sizeof(T));
+    }
+};
+
+template <typename T>
+using secure_unique_ptr = std::unique_ptr<T, SecureDelete<T>>;
+
+template <typename T, typename... Args>
+secure_unique_ptr<T> make_secure(Args&&... args) {
+    static_assert(alignof(T) <= SecureArena::ALIGNMENT, "over-aligned type");
+    void* p = SecureArena::global().allocate(sizeof(T));
+    try {
+        return secure_unique_ptr<T>(new (p) T(std::forward<Args>(args)...));
+    } catch (...) {
+        SecureArena::global().deallocate(p, sizeof(T));
+        throw;
+    }
+}
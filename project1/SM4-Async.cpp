@@ -0,0 +1,110 @@
+#include <iostream>
+#include <vector>
+#include <chrono>
+#include <atomic>
+#include "SM4-Async.h"
+using namespace std;
+
+// --- 测试 ---
+
+// 一条完整的处理链：加密 -> 解密 -> 对明文做SM3，每一步都co_await，不阻塞调用线程
+AsyncTask<bool> seal_open_hash(WorkStealingPool& pool, const vector<uint8_t>& message, int id) {
+    uint8_t key[16], iv[12], tag[16];
+    for (int i = 0; i < 16; ++i) key[i] = static_cast<uint8_t>(id + i);
+    for (int i = 0; i < 12; ++i) iv[i] = static_cast<uint8_t>(id * 3 + i);
+    const uint8_t aad[8] = { 'r', 'e', 'c', 'o', 'r', 'd', 0, static_cast<uint8_t>(id) };
+
+    vector<uint8_t> ciphertext(message.size()), decrypted(message.size());
+    co_await async_seal(pool, key, iv, message.data(), message.size(), aad, sizeof(aad), ciphertext.data(), tag);
+
+    // 与同步接口的结果一致
+    vector<uint8_t> expected(message.size());
+    uint8_t expected_tag[16];
+    sm4_gcm_encrypt(key, iv, message.data(), message.size(), aad, sizeof(aad), expected.data(), expected_tag);
+    if (ciphertext != expected || memcmp(tag, expected_tag, 16) != 0) co_return false;
+
+    bool valid = co_await async_open(pool, key, iv, ciphertext.data(), ciphertext.size(), aad, sizeof(aad), tag,
+                                     decrypted.data());
+    if (!valid || decrypted != message) co_return false;
+
+    tag[0] ^= 1;
+    bool forged = co_await async_open(pool, key, iv, ciphertext.data(), ciphertext.size(), aad, sizeof(aad), tag,
+                                      decrypted.data());
+    if (forged) co_return false;
+
+    vector<uint8_t> digest = co_await async_hash(pool, message.data(), message.size());
+    SM3Hash sm3;
+    co_return digest == sm3.compute(message.data(), message.size());
+}
+
+// 逐条co_await各处理链并汇总：AsyncTask惰性启动，各链依次执行，链内每一步都在线程池上完成
+AsyncTask<int> run_all(WorkStealingPool& pool, const vector<vector<uint8_t>>& messages) {
+    vector<AsyncTask<bool>> tasks;
+    for (size_t i = 0; i < messages.size(); ++i) {
+        tasks.push_back(seal_open_hash(pool, messages[i], static_cast<int>(i)));
+    }
+    int passed = 0;
+    for (AsyncTask<bool>& task : tasks) {
+        passed += co_await task ? 1 : 0;
+    }
+    co_return passed;
+}
+
+// 无返回值的协程：摘要写到调用方给的缓冲区
+AsyncTask<void> hash_into(WorkStealingPool& pool, const vector<uint8_t>& message, vector<uint8_t>& digest) {
+    digest = co_await async_hash(pool, message.data(), message.size());
+}
+
+void test_async_correctness() {
+    cout << "=== SM4-GCM / SM3 Coroutine API Test ===\n";
+    WorkStealingPool pool(4);
+    vector<vector<uint8_t>> messages;
+    for (size_t size : { 0, 1, 16, 100, 4096, 65537 }) {
+        vector<uint8_t> m(size);
+        for (size_t i = 0; i < size; ++i) m[i] = static_cast<uint8_t>(i * 7);
+        messages.push_back(m);
+    }
+    int passed = sync_wait(run_all(pool, messages));
+    cout << "Seal/Open/Hash chains: " << passed << "/" << messages.size() << " "
+         << (passed == static_cast<int>(messages.size()) ? "Passed" : "Failed") << endl;
+
+    vector<uint8_t> digest;
+    sync_wait(hash_into(pool, messages[4], digest));
+    SM3Hash sm3;
+    cout << "AsyncTask<void>: " << (digest == sm3.compute(messages[4].data(), messages[4].size()) ? "Passed" : "Failed")
+         << endl;
+}
+
+// 模拟事件循环：调用线程提交大块加密后继续做别的事，统计它在等待期间完成的"其他工作"
+AsyncTask<void> seal_large(WorkStealingPool& pool, vector<uint8_t>& data, vector<uint8_t>& out) {
+    uint8_t key[16] = { 0 }, iv[12] = { 0 }, tag[16];
+    co_await async_seal(pool, key, iv, data.data(), data.size(), nullptr, 0, out.data(), tag);
+}
+
+void test_async_offload() {
+    cout << "=== Reactor Offload Test ===\n";
+    WorkStealingPool pool(2);
+    vector<uint8_t> data(32 * 1024 * 1024, 0x5a), out(data.size());
+    atomic<bool> done{false};
+
+    auto start = chrono::high_resolution_clock::now();
+    // 运行到第一个co_await，把工作交给线程池后立即返回；协程帧销毁后才置done
+    seal_large(pool, data, out).start([&done] { done.store(true, memory_order_release); });
+    auto returned = chrono::high_resolution_clock::now();
+
+    uint64_t ticks = 0;
+    while (!done.load(memory_order_acquire)) {
+        ++ticks;   // 事件循环的其他工作
+        this_thread::yield();
+    }
+    auto end = chrono::high_resolution_clock::now();
+    cout << "Submit returned after " << chrono::duration<double, micro>(returned - start).count() << " us, "
+         << "seal finished after " << chrono::duration<double, milli>(end - start).count() << " ms, "
+         << "reactor loop iterations meanwhile: " << ticks << endl;
+}
+
+int main() {
+    test_async_correctness();
+    test_async_offload();
+    return 0;
+}
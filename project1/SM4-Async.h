@@ -0,0 +1,288 @@
+#pragma once
+
+#include <condition_variable>
+#include <coroutine>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <array>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <optional>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include "SM4-GCM.h"
+#include "WorkStealingPool.h"
+#include "../project4/SM3Hash.h"
+
+// SM4-GCM与SM3的C++20协程接口（需 -std=c++20）
+// co_await async_seal/async_open/async_hash 把计算交给执行器，完成后在执行器的线程上恢复调用方，
+// 事件循环线程在等待期间不被阻塞。语义与sm4_gcm_encrypt/sm4_gcm_decrypt/SM3Hash::compute相同，
+// 输入输出缓冲区须在co_await结束前保持有效
+// 执行器是任何提供 submit(std::function<void()>) 的对象，通常直接传入程序已有的WorkStealingPool
+
+// 在执行器上执行work，完成后恢复等待的协程；work抛出的异常在co_await处重新抛出
+template <typename R, typename Executor>
+class PoolAwaitable {
+public:
+    PoolAwaitable(Executor& pool, std::function<R()> work) : pool_(pool), work_(std::move(work)) {}
+
+    bool await_ready() const noexcept { return false; }
+
+    void await_suspend(std::coroutine_handle<> caller) {
+        // 提交之后不能再访问awaiter之外的状态：工作线程可能已经恢复了调用方
+        pool_.submit([this, caller] {
+            try {
+                if constexpr (std::is_void_v<R>) {
+                    work_();
+                } else {
+                    result_.emplace(work_());
+                }
+            } catch (...) {
+                error_ = std::current_exception();
+            }
+            caller.resume();
+        });
+    }
+
+    R await_resume() {
+        if (error_) std::rethrow_exception(error_);
+        if constexpr (!std::is_void_v<R>) return std::move(*result_);
+    }
+
+private:
+    struct Empty {};
+    Executor& pool_;
+    std::function<R()> work_;
+    std::optional<std::conditional_t<std::is_void_v<R>, Empty, R>> result_;
+    std::exception_ptr error_;
+};
+
+// --- SM4-GCM加密：结果写入ciphertext和tag ---
+template <typename Executor>
+PoolAwaitable<void, Executor> async_seal(Executor& pool, const uint8_t key[16], const uint8_t iv[12],
+    const uint8_t* plaintext, size_t pt_len,
+    const uint8_t* aad, size_t aad_len,
+    uint8_t* ciphertext, uint8_t tag[16]) {
+    std::array<uint8_t, 16> k;
+    std::array<uint8_t, 12> nonce;
+    memcpy(k.data(), key, 16);
+    memcpy(nonce.data(), iv, 12);
+    return PoolAwaitable<void, Executor>(pool, [=] {
+        sm4_gcm_encrypt(k.data(), nonce.data(), plaintext, pt_len, aad, aad_len, ciphertext, tag);
+    });
+}
+
+// --- SM4-GCM解密：co_await结果为认证是否通过 ---
+template <typename Executor>
+PoolAwaitable<bool, Executor> async_open(Executor& pool, const uint8_t key[16], const uint8_t iv[12],
+    const uint8_t* ciphertext, size_t ct_len,
+    const uint8_t* aad, size_t aad_len,
+    const uint8_t tag[16],
+    uint8_t* plaintext) {
+    std::array<uint8_t, 16> k;
+    std::array<uint8_t, 12> nonce;
+    std::array<uint8_t, 16> t;
+    memcpy(k.data(), key, 16);
+    memcpy(nonce.data(), iv, 12);
+    memcpy(t.data(), tag, 16);
+    return PoolAwaitable<bool, Executor>(pool, [=] {
+        return sm4_gcm_decrypt(k.data(), nonce.data(), ciphertext, ct_len, aad, aad_len, t.data(), plaintext);
+    });
+}
+
+// --- SM3：co_await结果为32字节摘要 ---
+template <typename Executor>
+PoolAwaitable<std::vector<uint8_t>, Executor> async_hash(Executor& pool, const uint8_t* data, size_t len) {
+    return PoolAwaitable<std::vector<uint8_t>, Executor>(pool, [=] {
+        SM3Hash sm3;
+        return sm3.compute(data, len);
+    });
+}
+
+// 协程结果的存放：有值的协程用return_value，AsyncTask<void>用return_void
+template <typename T>
+struct AsyncTaskResult {
+    using Callback = std::function<void(T)>;
+    std::optional<T> value;
+    void return_value(T v) { value.emplace(std::move(v)); }
+};
+
+template <>
+struct AsyncTaskResult<void> {
+    using Callback = std::function<void()>;
+    void return_void() {}
+};
+
+// --- 协程返回类型：惰性启动，可被co_await，也可用sync_wait在普通函数里等待；T可以是void ---
+template <typename T>
+class AsyncTask {
+public:
+    using Callback = typename AsyncTaskResult<T>::Callback;
+
+    struct promise_type : AsyncTaskResult<T> {
+        std::exception_ptr error;
+        std::coroutine_handle<> continuation;
+        bool detached = false;                 // 由start()分离，结束时自行销毁
+        Callback on_done;
+
+        AsyncTask get_return_object() {
+            return AsyncTask(std::coroutine_handle<promise_type>::from_promise(*this));
+        }
+        std::suspend_always initial_suspend() noexcept { return {}; }
+
+        // 结束时对称转移到等待者；分离的协程先销毁自己的帧，再用结果调用on_done
+        struct FinalAwaiter {
+            bool await_ready() const noexcept { return false; }
+            std::coroutine_handle<> await_suspend(std::coroutine_handle<promise_type> h) noexcept {
+                promise_type& p = h.promise();
+                if (p.detached) {
+                    Callback on_done = std::move(p.on_done);
+                    std::exception_ptr error = p.error;
+                    if constexpr (std::is_void_v<T>) {
+                        h.destroy();
+                        if (error) std::terminate();   // 分离的任务没有人接收异常，与std::thread相同
+                        if (on_done) on_done();
+                    } else {
+                        std::optional<T> value = std::move(p.value);
+                        h.destroy();
+                        if (error) std::terminate();
+                        if (on_done) on_done(std::move(*value));
+                    }
+                    return std::noop_coroutine();
+                }
+                std::coroutine_handle<> next = p.continuation;
+                return next ? next : std::noop_coroutine();
+            }
+            void await_resume() const noexcept {}
+        };
+        FinalAwaiter final_suspend() noexcept { return {}; }
+
+        void unhandled_exception() { error = std::current_exception(); }
+    };
+
+    explicit AsyncTask(std::coroutine_handle<promise_type> h) : handle_(h) {}
+    AsyncTask(AsyncTask&& other) noexcept : handle_(std::exchange(other.handle_, {})) {}
+    AsyncTask(const AsyncTask&) = delete;
+    AsyncTask& operator=(const AsyncTask&) = delete;
+
+    ~AsyncTask() {
+        if (handle_) handle_.destroy();
+    }
+
+    // co_await task：挂起调用方并启动task，task结束后恢复调用方
+    struct Awaiter {
+        std::coroutine_handle<promise_type> handle;
+
+        bool await_ready() const noexcept { return false; }
+
+        std::coroutine_handle<> await_suspend(std::coroutine_handle<> caller) noexcept {
+            handle.promise().continuation = caller;
+            return handle;
+        }
+
+        T await_resume() {
+            if (handle.promise().error) std::rethrow_exception(handle.promise().error);
+            if constexpr (!std::is_void_v<T>) return std::move(*handle.promise().value);
+        }
+    };
+
+    Awaiter operator co_await() & noexcept {
+        return Awaiter{ handle_ };
+    }
+
+    // 分离启动（事件循环用）：运行到第一个挂起点后返回，之后由工作线程继续。
+    // 协程帧归协程自己所有，结束时在最终挂起点销毁，然后以结果调用on_done（通常在工作线程上）；
+    // on_done被调用时协程已不再访问任何状态，调用方可据此释放协程引用的缓冲区
+    void start(Callback on_done = {}) && {
+        std::coroutine_handle<promise_type> h = std::exchange(handle_, {});
+        h.promise().detached = true;
+        h.promise().on_done = std::move(on_done);
+        h.resume();
+    }
+
+private:
+    std::coroutine_handle<promise_type> handle_;
+};
+
+// sync_wait内部使用的协程：在最终挂起点通知等待线程，此时协程帧已可安全销毁
+struct SyncWaitState {
+    std::mutex mutex;
+    std::condition_variable cv;
+    bool done = false;
+};
+
+class SyncWaitTask {
+public:
+    struct promise_type {
+        SyncWaitState* state = nullptr;
+
+        SyncWaitTask get_return_object() {
+            return SyncWaitTask(std::coroutine_handle<promise_type>::from_promise(*this));
+        }
+        std::suspend_always initial_suspend() noexcept { return {}; }
+
+        struct FinalAwaiter {
+            bool await_ready() const noexcept { return false; }
+            void await_suspend(std::coroutine_handle<promise_type> h) noexcept {
+                SyncWaitState* state = h.promise().state;
+                std::lock_guard<std::mutex> lock(state->mutex);   // 持锁通知，等待方醒来前本线程已不再访问state
+                state->done = true;
+                state->cv.notify_one();
+            }
+            void await_resume() const noexcept {}
+        };
+        FinalAwaiter final_suspend() noexcept { return {}; }
+
+        void return_void() {}
+        void unhandled_exception() { std::terminate(); }
+    };
+
+    explicit SyncWaitTask(std::coroutine_handle<promise_type> h) : handle_(h) {}
+    SyncWaitTask(const SyncWaitTask&) = delete;
+    SyncWaitTask& operator=(const SyncWaitTask&) = delete;
+
+    ~SyncWaitTask() {
+        if (handle_) handle_.destroy();
+    }
+
+    void start(SyncWaitState& state) {
+        handle_.promise().state = &state;
+        handle_.resume();
+    }
+
+private:
+    std::coroutine_handle<promise_type> handle_;
+};
+
+// 在当前线程阻塞等待一个AsyncTask（测试和非协程调用方使用）
+template <typename T>
+T sync_wait(AsyncTask<T> task) {
+    struct Empty {};
+    std::optional<std::conditional_t<std::is_void_v<T>, Empty, T>> result;
+    std::exception_ptr error;
+    AsyncTask<T>* awaited = &task;
+    auto runner = [&result, &error, awaited]() -> SyncWaitTask {
+        try {
+            if constexpr (std::is_void_v<T>) {
+                co_await *awaited;
+            } else {
+                result.emplace(co_await *awaited);
+            }
+        } catch (...) {
+            error = std::current_exception();
+        }
+    };
+
+    SyncWaitState state;
+    SyncWaitTask waiter = runner();
+    waiter.start(state);
+    {
+        std::unique_lock<std::mutex> lock(state.mutex);
+        state.cv.wait(lock, [&] { return state.done; });
+    }
+    if (error) std::rethrow_exception(error);
+    if constexpr (!std::is_void_v<T>) return std::move(*result);
+}
@@ -0,0 +1,196 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include "SM4-Core.h"
+#include "../project4/SM3Hash.h"
+#include "../project4/SM3HMAC.h"
+
+// TLCP风格的SM4-CBC + HMAC-SM3记录保护，先加密后MAC：tag = HMAC-SM3(mac_key, aad || IV || 密文)
+// CBC加密的分组链和SM3压缩链互不依赖。每压缩一个64字节SM3分组（64轮）的同时推进4个CBC分组（128轮SM4），
+// 通过SM3Hash::process_block的轮回调在同一个循环里交织，两条延迟链的指令相互填补流水线空隙，
+// 而不是先加密整条记录再对密文做一遍HMAC
+
+// --- HMAC-SM3密钥：预先吸收 K^ipad 和 K^opad 两个分组后的状态（由project4/SM3HMAC.h的HmacSm3::key_states计算）---
+struct HmacSm3Key {
+    std::array<uint32_t, 8> inner;
+    std::array<uint32_t, 8> outer;
+};
+
+inline void hmac_sm3_key_init(HmacSm3Key& ctx, const uint8_t* key, size_t key_len) {
+    SM3Hash::Midstate inner, outer;
+    HmacSm3::key_states(key, key_len, inner, outer);
+    ctx.inner = inner.state;
+    ctx.outer = outer.state;
+}
+
+// --- HMAC-SM3的内层杂凑状态（已吸收一个ipad分组）---
+struct HmacSm3State {
+    std::array<uint32_t, 8> state;
+    const HmacSm3Key* key;
+    uint8_t pending[SM3Hash::BLOCK_BYTES];
+    size_t pending_len;
+    uint64_t total;   // 含ipad分组的字节数
+
+    void start(const HmacSm3Key& k) {
+        key = &k;
+        state = k.inner;
+        pending_len = 0;
+        total = SM3Hash::BLOCK_BYTES;
+    }
+
+    void update(const uint8_t* data, size_t len) {
+        if (len == 0) return;
+        total += len;
+        if (pending_len > 0) {
+            size_t n = SM3Hash::BLOCK_BYTES - pending_len < len ? SM3Hash::BLOCK_BYTES - pending_len : len;
+            memcpy(pending + pending_len, data, n);
+            pending_len += n;
+            data += n;
+            len -= n;
+            if (pending_len < SM3Hash::BLOCK_BYTES) return;
+            SM3Hash::process_block(state, pending);
+            pending_len = 0;
+        }
+        for (; len >= SM3Hash::BLOCK_BYTES; data += SM3Hash::BLOCK_BYTES, len -= SM3Hash::BLOCK_BYTES) {
+            SM3Hash::process_block(state, data);
+        }
+        memcpy(pending, data, len);
+        pending_len = len;
+    }
+
+    // 已由交织内核压缩的整块，只计入长度
+    void skip_block() {
+        total += SM3Hash::BLOCK_BYTES;
+    }
+
+    void finish(uint8_t tag[32]) {
+        // 内层：从已压缩的整分组继续，填充pending中的尾部
+        uint8_t inner_digest[SM3Hash::DIGEST_BYTES];
+        SM3Hash::hash(SM3Hash::Midstate{ state, total - pending_len }, pending, pending_len, inner_digest);
+        // 外层：SM3(K^opad || 内层摘要)
+        SM3Hash::hash(SM3Hash::Midstate{ key->outer, SM3Hash::BLOCK_BYTES }, inner_digest, sizeof(inner_digest), tag);
+    }
+};
+
+// --- 交织内核：压缩一个SM3分组的同时CBC处理4个分组（in与out可以相同）---
+// SM3的第j轮之后执行第j/16个CBC分组的两轮SM4。chain为上一个密文分组（按字）；
+// 解密时先读入全部4个密文分组，sm3_block可以与正在原地解密的区域重叠（SM3在各轮开始前已读入整个分组）
+inline void cbc4_sm3_stitched(std::array<uint32_t, 8>& state, const uint8_t* sm3_block,
+    const uint32_t rk[32], uint32_t chain[4], const uint8_t* in, uint8_t* out, bool encrypt) {
+    uint32_t c[16];
+    for (int i = 0; i < 16; ++i) c[i] = SM4_Core::load_be32(in + 4 * i);
+    uint32_t x0 = 0, x1 = 0, x2 = 0, x3 = 0;
+    SM3Hash::process_block(state, sm3_block, [&](int j) {
+        int b = j >> 4;
+        int r = (j & 15) * 2;
+        if (r == 0) {
+            x0 = c[4 * b]; x1 = c[4 * b + 1]; x2 = c[4 * b + 2]; x3 = c[4 * b + 3];
+            if (encrypt) {
+                x0 ^= chain[0]; x1 ^= chain[1]; x2 ^= chain[2]; x3 ^= chain[3];
+            }
+        }
+        uint32_t next = x0 ^ SM4_Core::t_transform(x1 ^ x2 ^ x3 ^ rk[encrypt ? r : 31 - r]);
+        x0 = x1; x1 = x2; x2 = x3; x3 = next;
+        next = x0 ^ SM4_Core::t_transform(x1 ^ x2 ^ x3 ^ rk[encrypt ? r + 1 : 30 - r]);
+        x0 = x1; x1 = x2; x2 = x3; x3 = next;
+        if (r == 30) {
+            uint32_t y[4] = { x3, x2, x1, x0 };
+            if (encrypt) {
+                memcpy(chain, y, sizeof(y));
+            } else {
+                for (int i = 0; i < 4; ++i) {
+                    y[i] ^= chain[i];
+                    chain[i] = c[4 * b + i];
+                }
+            }
+            for (int i = 0; i < 4; ++i) SM4_Core::store_be32(out + 16 * b + 4 * i, y[i]);
+        }
+    });
+}
+
+// 不交织的CBC，处理n个分组
+inline void cbc_blocks(const uint32_t rk[32], uint32_t chain[4], const uint8_t* in, uint8_t* out, size_t n, bool encrypt) {
+    for (size_t b = 0; b < n; ++b) {
+        uint32_t x[4];
+        for (int i = 0; i < 4; ++i) x[i] = SM4_Core::load_be32(in + 16 * b + 4 * i);
+        uint32_t y[4] = { x[0], x[1], x[2], x[3] };
+        if (encrypt) {
+            for (int i = 0; i < 4; ++i) y[i] ^= chain[i];
+            SM4_Core::crypt_block(y, rk, true);
+            memcpy(chain, y, sizeof(y));
+        } else {
+            SM4_Core::crypt_block(y, rk, false);
+            for (int i = 0; i < 4; ++i) y[i] ^= chain[i];
+            memcpy(chain, x, sizeof(x));
+        }
+        for (int i = 0; i < 4; ++i) SM4_Core::store_be32(out + 16 * b + 4 * i, y[i]);
+    }
+}
+
+// --- 加密：in为整数个分组（记录填充由调用方完成），out可与in相同；写出32字节tag ---
+inline void sm4_cbc_hmac_sm3_seal(const uint32_t rk[32], const HmacSm3Key& mac_key, const uint8_t iv[16],
+    const uint8_t* aad, size_t aad_len, const uint8_t* in, uint8_t* out, size_t blocks, uint8_t tag[32]) {
+    HmacSm3State mac;
+    mac.start(mac_key);
+    mac.update(aad, aad_len);
+    mac.update(iv, 16);
+
+    uint32_t chain[4];
+    for (int i = 0; i < 4; ++i) chain[i] = SM4_Core::load_be32(iv + 4 * i);
+    const size_t len = blocks * 16;
+    // 密文的前first字节补齐MAC中未满的分组，此后的SM3分组在out中连续
+    const size_t first = mac.pending_len ? SM3Hash::BLOCK_BYTES - mac.pending_len : 0;
+    size_t mac_pos = 0;   // 已计入MAC的密文字节数
+    size_t done = 0;      // 已加密的字节数
+    for (; done + 64 <= len; done += 64) {
+        if (mac_pos < first && done >= first) {
+            mac.update(out, first);
+            mac_pos = first;
+        }
+        if (mac_pos >= first && mac_pos + 64 <= done) {
+            // 上一组密文已经写出，压缩它的同时加密这一组
+            cbc4_sm3_stitched(mac.state, out + mac_pos, rk, chain, in + done, out + done, true);
+            mac.skip_block();
+            mac_pos += 64;
+        } else {
+            cbc_blocks(rk, chain, in + done, out + done, 4, true);
+        }
+    }
+    cbc_blocks(rk, chain, in + done, out + done, (len - done) / 16, true);
+    mac.update(out + mac_pos, len - mac_pos);
+    mac.finish(tag);
+}
+
+// --- 解密并校验：返回true表示tag正确（与sm4_gcm_decrypt一样，明文总会写出），out可与in相同 ---
+inline bool sm4_cbc_hmac_sm3_open(const uint32_t rk[32], const HmacSm3Key& mac_key, const uint8_t iv[16],
+    const uint8_t* aad, size_t aad_len, const uint8_t* in, uint8_t* out, size_t blocks, const uint8_t tag[32]) {
+    HmacSm3State mac;
+    mac.start(mac_key);
+    mac.update(aad, aad_len);
+    mac.update(iv, 16);
+
+    uint32_t chain[4];
+    for (int i = 0; i < 4; ++i) chain[i] = SM4_Core::load_be32(iv + 4 * i);
+    const size_t len = blocks * 16;
+    // MAC领先于解密：先补齐未满的MAC分组，之后每组解密搭配从本组内开始的那个SM3分组
+    size_t mac_pos = mac.pending_len ? SM3Hash::BLOCK_BYTES - mac.pending_len : 0;
+    if (mac_pos > len) mac_pos = len;
+    mac.update(in, mac_pos);
+    size_t done = 0;
+    for (; done + 64 <= len && mac_pos + 64 <= len; done += 64) {
+        cbc4_sm3_stitched(mac.state, in + mac_pos, rk, chain, in + done, out + done, false);
+        mac.skip_block();
+        mac_pos += 64;
+    }
+    mac.update(in + mac_pos, len - mac_pos);
+    cbc_blocks(rk, chain, in + done, out + done, (len - done) / 16, false);
+
+    uint8_t calc_tag[32];
+    mac.finish(calc_tag);
+    uint8_t diff = 0;
+    for (int i = 0; i < 32; ++i) diff |= calc_tag[i] ^ tag[i];
+    return diff == 0;
+}
@@ -0,0 +1,260 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#ifdef __AVX2__
+#include <immintrin.h>
+#endif
+
+// SM4核心实现（头文件形式，供DRBG、文件加密等模块共用）
+namespace SM4_Core {
+
+constexpr uint8_t SBOX[256] = {
+    0xd6,0x90,0xe9,0xfe,0xcc,0xe1,0x3d,0xb7,0x16,0xb6,0x14,0xc2,0x28,0xfb,0x2c,0x05,
+    0x2b,0x67,0x9a,0x76,0x2a,0xbe,0x04,0xc3,0xaa,0x44,0x13,0x26,0x49,0x86,0x06,0x99,
+    0x9c,0x42,0x50,0xf4,0x91,0xef,0x98,0x7a,0x33,0x54,0x0b,0x43,0xed,0xcf,0xac,0x62,
+    0xe4,0xb3,0x1c,0xa9,0xc9,0x08,0xe8,0x95,0x80,0xdf,0x94,0xfa,0x75,0x8f,0x3f,0xa6,
+    0x47,0x07,0xa7,0xfc,0xf3,0x73,0x17,0xba,0x83,0x59,0x3c,0x19,0xe6,0x85,0x4f,0xa8,
+    0x68,0x6b,0x81,0xb2,0x71,0x64,0xda,0x8b,0xf8,0xeb,0x0f,0x4b,0x70,0x56,0x9d,0x35,
+    0x1e,0x24,0x0e,0x5e,0x63,0x58,0xd1,0xa2,0x25,0x22,0x7c,0x3b,0x01,0x21,0x78,0x87,
+    0xd4,0x00,0x46,0x57,0x9f,0xd3,0x27,0x52,0x4c,0x36,0x02,0xe7,0xa0,0xc4,0xc8,0x9e,
+    0xea,0xbf,0x8a,0xd2,0x40,0xc7,0x38,0xb5,0xa3,0xf7,0xf2,0xce,0xf9,0x61,0x15,0xa1,
+    0xe0,0xae,0x5d,0xa4,0x9b,0x34,0x1a,0x55,0xad,0x93,0x32,0x30,0xf5,0x8c,0xb1,0xe3,
+    0x1d,0xf6,0xe2,0x2e,0x82,0x66,0xca,0x60,0xc0,0x29,0x23,0xab,0x0d,0x53,0x4e,0x6f,
+    0xd5,0xdb,0x37,0x45,0xde,0xfd,0x8e,0x2f,0x03,0xff,0x6a,0x72,0x6d,0x6c,0x5b,0x51,
+    0x8d,0x1b,0xaf,0x92,0xbb,0xdd,0xbc,0x7f,0x11,0xd9,0x5c,0x41,0x1f,0x10,0x5a,0xd8,
+    0x0a,0xc1,0x31,0x88,0xa5,0xcd,0x7b,0xbd,0x2d,0x74,0xd0,0x12,0xb8,0xe5,0xb4,0xb0,
+    0x89,0x69,0x97,0x4a,0x0c,0x96,0x77,0x7e,0x65,0xb9,0xf1,0x09,0xc5,0x6e,0xc6,0x84,
+    0x18,0xf0,0x7d,0xec,0x3a,0xdc,0x4d,0x20,0x79,0xee,0x5f,0x3e,0xd7,0xcb,0x39,0x48
+};
+
+constexpr uint32_t FK[4] = { 0xa3b1bac6, 0x56aa3350, 0x677d9197, 0xb27022dc };
+
+constexpr uint32_t CK[32] = {
+    0x00070e15,0x1c232a31,0x383f464d,0x545b6269,0x70777e85,0x8c939aa1,0xa8afb6bd,0xc4cbd2d9,
+    0xe0e7eef5,0xfc030a11,0x181f262d,0x343b4249,0x50575e65,0x6c737a81,0x888f969d,0xa4abb2b9,
+    0xc0c7ced5,0xdce3eaf1,0xf8ff060d,0x141b2229,0x30373e45,0x4c535a61,0x686f767d,0x848b9299,
+    0xa0a7aeb5,0xbcc3cad1,0xd8dfe6ed,0xf4fb0209,0x10171e25,0x2c333a41,0x484f565d,0x646b7279
+};
+
+constexpr size_t BLOCK_BYTES = 16;
+
+constexpr uint32_t rotl(uint32_t x, int n) {
+    return (x << n) | (x >> (32 - n));
+}
+
+// 编译期生成T表：T[k][b] = L(S(b)) 放在第k个字节位置
+constexpr std::array<std::array<uint32_t, 256>, 4> make_t_table() {
+    std::array<std::array<uint32_t, 256>, 4> t{};
+    for (int i = 0; i < 256; ++i) {
+        uint32_t b = static_cast<uint32_t>(SBOX[i]) << 24;
+        uint32_t l = b ^ rotl(b, 2) ^ rotl(b, 10) ^ rotl(b, 18) ^ rotl(b, 24);
+        t[0][i] = l;
+        t[1][i] = rotl(l, 24);
+        t[2][i] = rotl(l, 16);
+        t[3][i] = rotl(l, 8);
+    }
+    return t;
+}
+
+alignas(64) inline constexpr std::array<std::array<uint32_t, 256>, 4> T_TABLE = make_t_table();
+
+inline uint32_t load_be32(const uint8_t* p) {
+    return (static_cast<uint32_t>(p[0]) << 24) | (static_cast<uint32_t>(p[1]) << 16) |
+           (static_cast<uint32_t>(p[2]) << 8) | static_cast<uint32_t>(p[3]);
+}
+
+inline void store_be32(uint8_t* p, uint32_t v) {
+    p[0] = static_cast<uint8_t>(v >> 24);
+    p[1] = static_cast<uint8_t>(v >> 16);
+    p[2] = static_cast<uint8_t>(v >> 8);
+    p[3] = static_cast<uint8_t>(v);
+}
+
+// 128位大端计数器加n（CTR模式）
+inline void counter128_add(uint8_t counter[16], uint64_t n) {
+    uint64_t high = (static_cast<uint64_t>(load_be32(counter)) << 32) | load_be32(counter + 4);
+    uint64_t low = (static_cast<uint64_t>(load_be32(counter + 8)) << 32) | load_be32(counter + 12);
+    uint64_t sum = low + n;
+    if (sum < low) ++high;
+    store_be32(counter, static_cast<uint32_t>(high >> 32));
+    store_be32(counter + 4, static_cast<uint32_t>(high));
+    store_be32(counter + 8, static_cast<uint32_t>(sum >> 32));
+    store_be32(counter + 12, static_cast<uint32_t>(sum));
+}
+
+// 查表实现的T变换
+inline uint32_t t_transform(uint32_t x) {
+    return T_TABLE[0][x >> 24] ^ T_TABLE[1][(x >> 16) & 0xff] ^
+           T_TABLE[2][(x >> 8) & 0xff] ^ T_TABLE[3][x & 0xff];
+}
+
+// 密钥扩展用的T'变换
+inline uint32_t t_prime_transform(uint32_t x) {
+    uint32_t b = (static_cast<uint32_t>(SBOX[x >> 24]) << 24) |
+                 (static_cast<uint32_t>(SBOX[(x >> 16) & 0xff]) << 16) |
+                 (static_cast<uint32_t>(SBOX[(x >> 8) & 0xff]) << 8) |
+                 static_cast<uint32_t>(SBOX[x & 0xff]);
+    return b ^ rotl(b, 13) ^ rotl(b, 23);
+}
+
+// 密钥扩展
+inline void expand_key(const uint32_t key[4], uint32_t rk[32]) {
+    uint32_t k0 = key[0] ^ FK[0], k1 = key[1] ^ FK[1], k2 = key[2] ^ FK[2], k3 = key[3] ^ FK[3];
+    for (int i = 0; i < 32; ++i) {
+        uint32_t next = k0 ^ t_prime_transform(k1 ^ k2 ^ k3 ^ CK[i]);
+        rk[i] = next;
+        k0 = k1; k1 = k2; k2 = k3; k3 = next;
+    }
+}
+
+inline void expand_key(const uint8_t key[16], uint32_t rk[32]) {
+    uint32_t key_u32[4];
+    for (int i = 0; i < 4; ++i) {
+        key_u32[i] = load_be32(key + 4 * i);
+    }
+    expand_key(key_u32, rk);
+}
+
+// 单分组加解密
+inline void crypt_block(uint32_t block[4], const uint32_t rk[32], bool encrypt = true) {
+    uint32_t x0 = block[0], x1 = block[1], x2 = block[2], x3 = block[3];
+    for (int i = 0; i < 32; ++i) {
+        uint32_t next = x0 ^ t_transform(x1 ^ x2 ^ x3 ^ rk[encrypt ? i : 31 - i]);
+        x0 = x1; x1 = x2; x2 = x3; x3 = next;
+    }
+    block[0] = x3; block[1] = x2; block[2] = x1; block[3] = x0;
+}
+
+inline void crypt_block(const uint8_t in[16], uint8_t out[16], const uint32_t rk[32], bool encrypt = true) {
+    uint32_t block[4];
+    for (int i = 0; i < 4; ++i) {
+        block[i] = load_be32(in + 4 * i);
+    }
+    crypt_block(block, rk, encrypt);
+    for (int i = 0; i < 4; ++i) {
+        store_be32(out + 4 * i, block[i]);
+    }
+}
+
+// 8分组内核：8个分组交错执行，AVX2下每个分组占一个32位通道
+inline void crypt_blocks8(const uint8_t* in, uint8_t* out, const uint32_t rk[32], bool encrypt = true) {
+    alignas(32) uint32_t x[4][8];
+    for (int b = 0; b < 8; ++b) {
+        for (int j = 0; j < 4; ++j) {
+            x[j][b] = load_be32(in + b * BLOCK_BYTES + 4 * j);
+        }
+    }
+
+#ifdef __AVX2__
+    const __m256i mask = _mm256_set1_epi32(0xff);
+    __m256i v[4];
+    for (int j = 0; j < 4; ++j) {
+        v[j] = _mm256_load_si256(reinterpret_cast<const __m256i*>(x[j]));
+    }
+    for (int i = 0; i < 32; ++i) {
+        __m256i t = _mm256_xor_si256(_mm256_xor_si256(v[1], v[2]),
+                                     _mm256_xor_si256(v[3], _mm256_set1_epi32(static_cast<int>(rk[encrypt ? i : 31 - i]))));
+        __m256i t0 = _mm256_i32gather_epi32(reinterpret_cast<const int*>(T_TABLE[0].data()), _mm256_srli_epi32(t, 24), 4);
+        __m256i t1 = _mm256_i32gather_epi32(reinterpret_cast<const int*>(T_TABLE[1].data()),
+                                            _mm256_and_si256(_mm256_srli_epi32(t, 16), mask), 4);
+        __m256i t2 = _mm256_i32gather_epi32(reinterpret_cast<const int*>(T_TABLE[2].data()),
+                                            _mm256_and_si256(_mm256_srli_epi32(t, 8), mask), 4);
+        __m256i t3 = _mm256_i32gather_epi32(reinterpret_cast<const int*>(T_TABLE[3].data()), _mm256_and_si256(t, mask), 4);
+        __m256i next = _mm256_xor_si256(v[0], _mm256_xor_si256(_mm256_xor_si256(t0, t1), _mm256_xor_si256(t2, t3)));
+        v[0] = v[1]; v[1] = v[2]; v[2] = v[3]; v[3] = next;
+    }
+    for (int j = 0; j < 4; ++j) {
+        _mm256_store_si256(reinterpret_cast<__m256i*>(x[j]), v[j]);
+    }
+#else
+    for (int i = 0; i < 32; ++i) {
+        uint32_t k = rk[encrypt ? i : 31 - i];
+        for (int b = 0; b < 8; ++b) {
+            uint32_t next = x[0][b] ^ t_transform(x[1][b] ^ x[2][b] ^ x[3][b] ^ k);
+            x[0][b] = x[1][b]; x[1][b] = x[2][b]; x[2][b] = x[3][b]; x[3][b] = next;
+        }
+    }
+#endif
+
+    // 反序输出
+    for (int b = 0; b < 8; ++b) {
+        for (int j = 0; j < 4; ++j) {
+            store_be32(out + b * BLOCK_BYTES + 4 * j, x[3 - j][b]);
+        }
+    }
+}
+
+// 多密钥8分组内核（按字存放）：x[j][b]为第b个分组的第j个字，第b个分组用第b把密钥；
+// rk_soa[i][b]为第b把密钥的第i轮轮密钥（按轮转置的布局，AVX2下每轮一次加载）。结果按反序写回x
+inline void crypt_words8_multikey(uint32_t x[4][8], const uint32_t rk_soa[32][8], bool encrypt = true) {
+#ifdef __AVX2__
+    const __m256i mask = _mm256_set1_epi32(0xff);
+    __m256i v[4];
+    for (int j = 0; j < 4; ++j) {
+        v[j] = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(x[j]));
+    }
+    for (int i = 0; i < 32; ++i) {
+        __m256i k = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(rk_soa[encrypt ? i : 31 - i]));
+        __m256i t = _mm256_xor_si256(_mm256_xor_si256(v[1], v[2]), _mm256_xor_si256(v[3], k));
+        __m256i t0 = _mm256_i32gather_epi32(reinterpret_cast<const int*>(T_TABLE[0].data()), _mm256_srli_epi32(t, 24), 4);
+        __m256i t1 = _mm256_i32gather_epi32(reinterpret_cast<const int*>(T_TABLE[1].data()),
+                                            _mm256_and_si256(_mm256_srli_epi32(t, 16), mask), 4);
+        __m256i t2 = _mm256_i32gather_epi32(reinterpret_cast<const int*>(T_TABLE[2].data()),
+                                            _mm256_and_si256(_mm256_srli_epi32(t, 8), mask), 4);
+        __m256i t3 = _mm256_i32gather_epi32(reinterpret_cast<const int*>(T_TABLE[3].data()), _mm256_and_si256(t, mask), 4);
+        __m256i next = _mm256_xor_si256(v[0], _mm256_xor_si256(_mm256_xor_si256(t0, t1), _mm256_xor_si256(t2, t3)));
+        v[0] = v[1]; v[1] = v[2]; v[2] = v[3]; v[3] = next;
+    }
+    for (int j = 0; j < 4; ++j) {
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(x[j]), v[3 - j]);
+    }
+#else
+    for (int i = 0; i < 32; ++i) {
+        const uint32_t* k = rk_soa[encrypt ? i : 31 - i];
+        for (int b = 0; b < 8; ++b) {
+            uint32_t next = x[0][b] ^ t_transform(x[1][b] ^ x[2][b] ^ x[3][b] ^ k[b]);
+            x[0][b] = x[1][b]; x[1][b] = x[2][b]; x[2][b] = x[3][b]; x[3][b] = next;
+        }
+    }
+    for (int b = 0; b < 8; ++b) {
+        uint32_t t = x[0][b]; x[0][b] = x[3][b]; x[3][b] = t;
+        t = x[1][b]; x[1][b] = x[2][b]; x[2][b] = t;
+    }
+#endif
+}
+
+// 多密钥8分组内核（按字节分组）：第b个分组用rk[b]，用于把不同密钥的零散分组凑成满批。
+// 轮密钥转置后交给crypt_words8_multikey
+inline void crypt_blocks8_multikey(const uint8_t* in, uint8_t* out, const uint32_t* const rk[8], bool encrypt = true) {
+    uint32_t x[4][8], rk_soa[32][8];
+    for (int b = 0; b < 8; ++b) {
+        for (int j = 0; j < 4; ++j) {
+            x[j][b] = load_be32(in + b * BLOCK_BYTES + 4 * j);
+        }
+        for (int i = 0; i < 32; ++i) {
+            rk_soa[i][b] = rk[b][i];
+        }
+    }
+    crypt_words8_multikey(x, rk_soa, encrypt);
+    for (int b = 0; b < 8; ++b) {
+        for (int j = 0; j < 4; ++j) {
+            store_be32(out + b * BLOCK_BYTES + 4 * j, x[j][b]);
+        }
+    }
+}
+
+// 多分组加解密（ECB），in与out可以相同
+inline void crypt_blocks(const uint8_t* in, uint8_t* out, size_t blocks, const uint32_t rk[32], bool encrypt = true) {
+    size_t i = 0;
+    for (; i + 8 <= blocks; i += 8) {
+        crypt_blocks8(in + i * BLOCK_BYTES, out + i * BLOCK_BYTES, rk, encrypt);
+    }
+    for (; i < blocks; ++i) {
+        crypt_block(in + i * BLOCK_BYTES, out + i * BLOCK_BYTES, rk, encrypt);
+    }
+}
+
+} // namespace SM4_Core
@@ -0,0 +1,177 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <random>
+#if defined(__unix__) || defined(__APPLE__)
+#include <pthread.h>
+#define SM4_DRBG_FORK_DETECT 1
+#endif
+#include "SM4-Core.h"
+
+// 基于SM4的CTR_DRBG（参照NIST SP 800-90A，不使用派生函数）
+// 输出按 SM4(K, V+1) || SM4(K, V+2) || ... 生成，每次请求结束后更新K、V
+// fork后子进程继承父进程的完整状态：pthread_atfork在子进程里推进fork代数，
+// 实例在下一次生成请求时发现代数变化即先重播种，父子进程不会输出相同的随机数
+class SM4CtrDrbg {
+public:
+    static constexpr size_t SEED_BYTES = 32;                   // seedlen = 密钥长度 + 分组长度
+    static constexpr size_t MAX_REQUEST_BYTES = 1 << 16;       // 单次生成请求的最大输出
+    static constexpr uint64_t RESEED_INTERVAL = 1ULL << 24;    // 生成请求次数上限，超过后自动重播种
+
+    // 从系统熵源播种
+    SM4CtrDrbg() {
+        uint8_t seed[SEED_BYTES];
+        read_entropy(seed);
+        instantiate(seed);
+        wipe(seed, sizeof(seed));
+    }
+
+    // 用给定种子播种，输出可复现（测试夹具用）
+    explicit SM4CtrDrbg(const uint8_t seed[SEED_BYTES]) {
+        instantiate(seed);
+    }
+
+    SM4CtrDrbg(const SM4CtrDrbg&) = delete;
+    SM4CtrDrbg& operator=(const SM4CtrDrbg&) = delete;
+
+    ~SM4CtrDrbg() {
+        wipe(key_, sizeof(key_));
+        wipe(round_keys_, sizeof(round_keys_));
+        v_high_ = v_low_ = 0;
+    }
+
+    // 重新播种：新熵与附加输入（可为空，最多SEED_BYTES字节）异或后并入状态
+    void reseed(const uint8_t* additional = nullptr, size_t len = 0) {
+        uint8_t seed[SEED_BYTES];
+        read_entropy(seed);
+        for (size_t i = 0; i < len && i < SEED_BYTES; ++i) {
+            seed[i] ^= additional[i];
+        }
+        update(seed);
+        reseed_counter_ = 1;
+        fork_generation_ = current_fork_generation();
+        wipe(seed, sizeof(seed));
+    }
+
+    // 批量输出随机字节，按MAX_REQUEST_BYTES切分为多次生成请求
+    void fill(void* buffer, size_t len) {
+        uint8_t* out = static_cast<uint8_t*>(buffer);
+        while (len > 0) {
+            size_t chunk = len < MAX_REQUEST_BYTES ? len : MAX_REQUEST_BYTES;
+            generate(out, chunk);
+            out += chunk;
+            len -= chunk;
+        }
+    }
+
+    uint64_t reseed_counter() const {
+        return reseed_counter_;
+    }
+
+    // 每线程一个实例，线程间无需加锁
+    static SM4CtrDrbg& thread_instance() {
+        thread_local SM4CtrDrbg instance;
+        return instance;
+    }
+
+private:
+    uint8_t key_[16];
+    uint32_t round_keys_[32];
+    uint64_t v_high_ = 0, v_low_ = 0;  // 128位计数器V（大端的高/低64位）
+    uint64_t reseed_counter_ = 0;
+    uint64_t fork_generation_ = 0;     // 播种时的fork代数
+
+    // 进程至今经历的fork次数（只在子进程中递增）；首次调用时注册atfork处理函数
+    static uint64_t current_fork_generation() {
+        static std::atomic<uint64_t> generation{0};
+#ifdef SM4_DRBG_FORK_DETECT
+        static const int registered = pthread_atfork(nullptr, nullptr, [] {
+            generation.fetch_add(1, std::memory_order_relaxed);
+        });
+        (void)registered;
+#endif
+        return generation.load(std::memory_order_relaxed);
+    }
+
+    static void wipe(void* p, size_t len) {
+        volatile uint8_t* bytes = static_cast<volatile uint8_t*>(p);
+        while (len--) *bytes++ = 0;
+    }
+
+    static void read_entropy(uint8_t seed[SEED_BYTES]) {
+        std::random_device rd;
+        for (size_t i = 0; i < SEED_BYTES; i += 4) {
+            uint32_t word = rd();
+            std::memcpy(seed + i, &word, 4);
+        }
+    }
+
+    static void store_be64(uint8_t* p, uint64_t v) {
+        SM4_Core::store_be32(p, static_cast<uint32_t>(v >> 32));
+        SM4_Core::store_be32(p + 4, static_cast<uint32_t>(v));
+    }
+
+    static uint64_t load_be64(const uint8_t* p) {
+        return (static_cast<uint64_t>(SM4_Core::load_be32(p)) << 32) | SM4_Core::load_be32(p + 4);
+    }
+
+    // 写入计数器 V+1, V+2, ...，共blocks个分组，并推进V
+    void write_counters(uint8_t* out, size_t blocks) {
+        for (size_t i = 0; i < blocks; ++i) {
+            if (++v_low_ == 0) ++v_high_;
+            store_be64(out + i * SM4_Core::BLOCK_BYTES, v_high_);
+            store_be64(out + i * SM4_Core::BLOCK_BYTES + 8, v_low_);
+        }
+    }
+
+    void instantiate(const uint8_t seed[SEED_BYTES]) {
+        std::memset(key_, 0, sizeof(key_));
+        SM4_Core::expand_key(key_, round_keys_);
+        v_high_ = v_low_ = 0;
+        update(seed);
+        reseed_counter_ = 1;
+        fork_generation_ = current_fork_generation();
+    }
+
+    // CTR_DRBG_Update：temp = E(K, V+1) || E(K, V+2)，与provided异或后拆成新的K和V
+    void update(const uint8_t provided[SEED_BYTES]) {
+        uint8_t temp[SEED_BYTES];
+        write_counters(temp, SEED_BYTES / SM4_Core::BLOCK_BYTES);
+        SM4_Core::crypt_blocks(temp, temp, SEED_BYTES / SM4_Core::BLOCK_BYTES, round_keys_);
+        for (size_t i = 0; i < SEED_BYTES; ++i) {
+            temp[i] ^= provided[i];
+        }
+        std::memcpy(key_, temp, sizeof(key_));
+        SM4_Core::expand_key(key_, round_keys_);
+        v_high_ = load_be64(temp + 16);
+        v_low_ = load_be64(temp + 24);
+        wipe(temp, sizeof(temp));
+    }
+
+    // 单次生成请求：计数器分组直接写进输出缓冲区，再用多分组内核原地加密
+    void generate(uint8_t* out, size_t len) {
+        if (reseed_counter_ > RESEED_INTERVAL || fork_generation_ != current_fork_generation()) {
+            reseed();
+        }
+
+        size_t blocks = len / SM4_Core::BLOCK_BYTES;
+        write_counters(out, blocks);
+        SM4_Core::crypt_blocks(out, out, blocks, round_keys_);
+
+        size_t rem = len % SM4_Core::BLOCK_BYTES;
+        if (rem) {
+            uint8_t last[SM4_Core::BLOCK_BYTES];
+            write_counters(last, 1);
+            SM4_Core::crypt_block(last, last, round_keys_);
+            std::memcpy(out + blocks * SM4_Core::BLOCK_BYTES, last, rem);
+            wipe(last, sizeof(last));
+        }
+
+        const uint8_t zero[SEED_BYTES] = {0};
+        update(zero);
+        ++reseed_counter_;
+    }
+};
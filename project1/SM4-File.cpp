@@ -0,0 +1,908 @@
+#include <iostream>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <deque>
+#include <map>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <new>
+#include <algorithm>
+#include <array>
+#include <sys/stat.h>
+#ifdef _WIN32
+#include <io.h>
+#include <fcntl.h>
+#endif
+#ifdef __linux__
+#include <cerrno>
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <sys/uio.h>
+#include <unistd.h>
+#endif
+#include "SM4-GCM.h"
+#include "SM4-DRBG.h"
+
+using namespace std;
+
+// 文件/管道加解密工具：读线程 -> 加解密线程 -> 写线程，三者通过有界队列传递对齐的缓冲块
+// 输出格式：IV（CBC/CTR为16字节，GCM为12字节，ECB无） || 数据 || TAG（仅GCM，16字节）
+
+enum class Mode { ECB, CBC, CTR, GCM };
+
+constexpr size_t CHUNK_BYTES = 1 << 20;   // 每块数据大小（16的倍数）
+constexpr size_t BUFFER_ALIGN = 64;
+constexpr size_t BUFFER_BYTES = CHUNK_BYTES + 2 * SM4_Core::BLOCK_BYTES;  // 留出填充/TAG的空间
+
+struct Options {
+    bool encrypt = true;
+    Mode mode = Mode::GCM;
+    uint8_t key[16];
+    bool has_key = false;
+    vector<uint8_t> iv;
+    string input = "-", output = "-";
+    bool use_uring = false;
+    unsigned threads = max(1u, thread::hardware_concurrency());
+};
+
+// 数据块：输入、输出各一块对齐缓冲区
+struct Chunk {
+    uint8_t* in = nullptr;
+    uint8_t* out = nullptr;
+    size_t in_len = 0, out_len = 0;
+    uint64_t seq = 0;             // 块序号，写线程按序输出
+    uint64_t offset = 0;          // 本块数据在数据流中的偏移（不含IV）
+    bool final = false;
+    bool ok = true;               // 长度或填充错误时置为false
+    uint8_t prev_block[16];       // CBC解密：前一个密文分组
+    uint8_t tag[16];              // GCM解密：数据流末尾的TAG
+};
+
+// 有界阻塞队列
+template <typename T>
+class BoundedQueue {
+public:
+    explicit BoundedQueue(size_t capacity) : capacity_(capacity) {}
+
+    void push(T item) {
+        unique_lock<mutex> lock(mutex_);
+        not_full_.wait(lock, [&] { return items_.size() < capacity_; });
+        items_.push_back(move(item));
+        not_empty_.notify_one();
+    }
+
+    // 队列已关闭且为空时返回false
+    bool pop(T& item) {
+        unique_lock<mutex> lock(mutex_);
+        not_empty_.wait(lock, [&] { return !items_.empty() || closed_; });
+        if (items_.empty()) return false;
+        item = move(items_.front());
+        items_.pop_front();
+        not_full_.notify_one();
+        return true;
+    }
+
+    void close() {
+        lock_guard<mutex> lock(mutex_);
+        closed_ = true;
+        not_empty_.notify_all();
+    }
+
+private:
+    size_t capacity_;
+    deque<T> items_;
+    bool closed_ = false;
+    mutex mutex_;
+    condition_variable not_full_, not_empty_;
+};
+
+// 读满n字节，除非遇到文件结尾
+size_t read_full(FILE* file, uint8_t* buffer, size_t n) {
+    size_t total = 0;
+    while (total < n) {
+        size_t got = fread(buffer + total, 1, n - total, file);
+        if (got == 0) break;
+        total += got;
+    }
+    return total;
+}
+
+const char* const GCM_TOO_LONG = "input exceeds the GCM limit of 2^32-2 blocks per message";
+
+// 普通文件的大小；管道等大小未知时返回false
+bool regular_file_size(FILE* file, uint64_t& size) {
+    struct stat st;
+    if (fstat(fileno(file), &st) != 0 || !S_ISREG(st.st_mode)) return false;
+    size = static_cast<uint64_t>(st.st_size);
+    return true;
+}
+
+// GCM：已知大小的输入在写出任何数据之前检查长度上限（解密时扣除IV和TAG）
+bool gcm_input_fits(const Options& options, FILE* input) {
+    uint64_t size;
+    if (options.mode != Mode::GCM || !regular_file_size(input, size)) return true;
+    uint64_t overhead = options.encrypt ? 0 : 12 + 16;
+    return size <= overhead || gcm_length_ok(size - overhead);
+}
+
+// CTR/GCM：从数据流偏移offset（16的倍数）处开始，keystream与in异或写到out，in与out可以相同
+// CTR按128位递增计数器，GCM按inc32递增
+void ctr_xor(Mode mode, const uint8_t counter0[16], const uint32_t rk[32], uint64_t offset,
+             const uint8_t* in, uint8_t* out, size_t len) {
+    constexpr size_t BATCH_BLOCKS = 256;
+    alignas(BUFFER_ALIGN) uint8_t keystream[BATCH_BLOCKS * 16];
+    uint8_t counter[16];
+    memcpy(counter, counter0, 16);
+    if (mode == Mode::GCM) {
+        gcm_counter_add(counter, static_cast<uint32_t>(offset / 16));
+    } else {
+        SM4_Core::counter128_add(counter, offset / 16);
+    }
+
+    while (len > 0) {
+        size_t blocks = min((len + 15) / 16, BATCH_BLOCKS);
+        for (size_t b = 0; b < blocks; ++b) {
+            memcpy(keystream + b * 16, counter, 16);
+            if (mode == Mode::GCM) {
+                gcm_counter_add(counter, 1);
+            } else {
+                SM4_Core::counter128_add(counter, 1);
+            }
+        }
+        SM4_Core::crypt_blocks(keystream, keystream, blocks, rk);
+        size_t n = min(blocks * 16, len);
+        for (size_t i = 0; i < n; ++i) {
+            out[i] = in[i] ^ keystream[i];
+        }
+        in += n;
+        out += n;
+        len -= n;
+    }
+}
+
+class FilePipeline {
+public:
+    FilePipeline(const Options& options, FILE* input, FILE* output)
+        : options_(options), input_(input), output_(output),
+          pool_size_(options.threads * 2 + 2), free_(pool_size_), work_(pool_size_), done_(pool_size_) {
+        SM4_Core::expand_key(options.key, rk_);
+        for (size_t i = 0; i < pool_size_; ++i) {
+            chunks_.emplace_back();
+            chunks_.back().in = static_cast<uint8_t*>(::operator new(BUFFER_BYTES, align_val_t(BUFFER_ALIGN)));
+            chunks_.back().out = static_cast<uint8_t*>(::operator new(BUFFER_BYTES, align_val_t(BUFFER_ALIGN)));
+            free_.push(&chunks_.back());
+        }
+    }
+
+    ~FilePipeline() {
+        for (Chunk& chunk : chunks_) {
+            ::operator delete(chunk.in, align_val_t(BUFFER_ALIGN));
+            ::operator delete(chunk.out, align_val_t(BUFFER_ALIGN));
+        }
+    }
+
+    bool run(const uint8_t* iv) {
+        if (options_.mode == Mode::GCM) {
+            uint8_t zero[16] = { 0 };
+            SM4_Core::crypt_block(zero, H_, rk_);
+            memset(J0_, 0, 16);
+            memcpy(J0_, iv, 12);
+            J0_[15] = 1;
+            memcpy(counter0_, J0_, 16);
+            gcm_counter_add(counter0_, 1);
+            ghash_.init(H_);
+        } else if (options_.mode != Mode::ECB) {
+            memcpy(counter0_, iv, 16);
+            memcpy(cbc_state_, iv, 16);
+        }
+
+        // CBC加密前后分组相关，只能单线程按序处理
+        unsigned workers = (options_.mode == Mode::CBC && options_.encrypt) ? 1 : options_.threads;
+        active_workers_ = workers;
+
+        vector<thread> threads;
+        threads.emplace_back(&FilePipeline::reader, this);
+        for (unsigned i = 0; i < workers; ++i) {
+            threads.emplace_back(&FilePipeline::worker, this);
+        }
+        threads.emplace_back(&FilePipeline::writer, this);
+        for (thread& t : threads) {
+            t.join();
+        }
+        return !failed_;
+    }
+
+private:
+    const Options& options_;
+    FILE* input_;
+    FILE* output_;
+    size_t pool_size_;
+    deque<Chunk> chunks_;
+    BoundedQueue<Chunk*> free_, work_, done_;
+    atomic<unsigned> active_workers_{0};
+    atomic<bool> failed_{false};
+
+    uint32_t rk_[32];
+    uint8_t counter0_[16];    // CTR/GCM：第一个数据分组的计数器
+    uint8_t cbc_state_[16];   // CBC加密：上一个密文分组
+    uint8_t H_[16], J0_[16];
+    GHASH ghash_;
+
+    void fail(const char* message) {
+        if (!failed_.exchange(true)) {
+            cerr << "sm4_file: " << message << endl;
+        }
+    }
+
+    // 解密ECB/CBC时保留最后一个分组（含填充），GCM解密时保留末尾的TAG，保证它们落在最后一块中
+    size_t tail_reserve() const {
+        return (!options_.encrypt && options_.mode != Mode::CTR) ? SM4_Core::BLOCK_BYTES : 0;
+    }
+
+    void reader() {
+        const size_t reserve = tail_reserve();
+        uint8_t carry[16];
+        size_t carry_len = 0;
+        uint8_t last_cipher_block[16];
+        memcpy(last_cipher_block, cbc_state_, 16);
+        uint64_t seq = 0, offset = 0;
+
+        while (!failed_) {
+            Chunk* chunk;
+            if (!free_.pop(chunk)) break;
+
+            memcpy(chunk->in, carry, carry_len);
+            size_t filled = carry_len + read_full(input_, chunk->in + carry_len, CHUNK_BYTES + reserve - carry_len);
+            if (ferror(input_)) {
+                fail("read error");
+                free_.push(chunk);
+                break;
+            }
+
+            bool eof = filled < CHUNK_BYTES + reserve;
+            size_t data_len = eof ? filled : CHUNK_BYTES;
+            if (!eof) {
+                carry_len = reserve;
+                memcpy(carry, chunk->in + CHUNK_BYTES, carry_len);
+            } else if (options_.mode == Mode::GCM && !options_.encrypt) {
+                if (filled < 16) {
+                    fail("input too short to contain a GCM tag");
+                    free_.push(chunk);
+                    break;
+                }
+                data_len = filled - 16;
+                memcpy(chunk->tag, chunk->in + data_len, 16);
+            }
+
+            // 大小未知的输入（管道）在开始前无法检查，读到超限时停止
+            if (options_.mode == Mode::GCM && !gcm_length_ok(offset + data_len)) {
+                fail(GCM_TOO_LONG);
+                free_.push(chunk);
+                break;
+            }
+            chunk->in_len = data_len;
+            chunk->seq = seq++;
+            chunk->offset = offset;
+            chunk->final = eof;
+            chunk->ok = true;
+            if (options_.mode == Mode::CBC && !options_.encrypt) {
+                memcpy(chunk->prev_block, last_cipher_block, 16);
+                if (data_len >= 16) {
+                    memcpy(last_cipher_block, chunk->in + (data_len & ~size_t(15)) - 16, 16);
+                }
+            }
+            offset += data_len;
+            work_.push(chunk);
+            if (eof) break;
+        }
+        work_.close();
+    }
+
+    void worker() {
+        Chunk* chunk;
+        while (work_.pop(chunk)) {
+            if (!failed_) {
+                process(*chunk);
+            }
+            done_.push(chunk);
+        }
+        if (--active_workers_ == 0) {
+            done_.close();
+        }
+    }
+
+    void writer() {
+        map<uint64_t, Chunk*> pending;
+        uint64_t next = 0;
+        Chunk* chunk;
+        while (done_.pop(chunk)) {
+            pending[chunk->seq] = chunk;
+            for (auto it = pending.find(next); it != pending.end(); it = pending.find(next)) {
+                Chunk* current = it->second;
+                pending.erase(it);
+                ++next;
+                if (!failed_) {
+                    emit(*current);
+                }
+                free_.push(current);
+            }
+        }
+        for (auto& entry : pending) {
+            free_.push(entry.second);
+        }
+    }
+
+    // 写线程按序输出一块，GCM在这里顺序计算GHASH
+    void emit(Chunk& chunk) {
+        if (!chunk.ok) {
+            fail(options_.encrypt ? "encryption failed" : "invalid ciphertext length or padding");
+            return;
+        }
+        if (options_.mode == Mode::GCM) {
+            ghash_.update_padded(options_.encrypt ? chunk.out : chunk.in, chunk.in_len);
+        }
+        if (chunk.out_len && fwrite(chunk.out, 1, chunk.out_len, output_) != chunk.out_len) {
+            fail("write error");
+            return;
+        }
+        if (chunk.final && options_.mode == Mode::GCM) {
+            uint8_t tag[16], s[16];
+            uint64_t data_len = chunk.offset + chunk.in_len;
+            ghash_.finalize(0, data_len, tag);
+            SM4_Core::crypt_block(J0_, s, rk_);
+            xor_128(tag, tag, s);
+            if (options_.encrypt) {
+                if (fwrite(tag, 1, 16, output_) != 16) fail("write error");
+            } else {
+                uint8_t diff = 0;
+                for (int i = 0; i < 16; ++i) diff |= tag[i] ^ chunk.tag[i];
+                if (diff) fail("authentication failed");
+            }
+        }
+    }
+
+    // PKCS#7填充：in中剩余不足16字节的数据补齐后写到out，返回写入长度（16）
+    static size_t pad_block(const uint8_t* in, size_t rem, uint8_t out[16]) {
+        memcpy(out, in, rem);
+        memset(out + rem, static_cast<int>(16 - rem), 16 - rem);
+        return 16;
+    }
+
+    // 检查并去除PKCS#7填充，返回去除后的长度，填充非法时返回SIZE_MAX
+    static size_t strip_padding(const uint8_t* data, size_t len) {
+        if (len < 16) return SIZE_MAX;
+        uint8_t pad = data[len - 1];
+        if (pad == 0 || pad > 16) return SIZE_MAX;
+        for (size_t i = len - pad; i < len; ++i) {
+            if (data[i] != pad) return SIZE_MAX;
+        }
+        return len - pad;
+    }
+
+    void process_ctr(Chunk& chunk) {
+        ctr_xor(options_.mode, counter0_, rk_, chunk.offset, chunk.in, chunk.out, chunk.in_len);
+        chunk.out_len = chunk.in_len;
+    }
+
+    void process(Chunk& chunk) {
+        const size_t full_blocks = chunk.in_len / 16;
+        const size_t rem = chunk.in_len % 16;
+
+        switch (options_.mode) {
+        case Mode::CTR:
+        case Mode::GCM:
+            process_ctr(chunk);
+            return;
+
+        case Mode::ECB:
+            if (options_.encrypt) {
+                SM4_Core::crypt_blocks(chunk.in, chunk.out, full_blocks, rk_);
+                chunk.out_len = full_blocks * 16;
+                if (chunk.final) {
+                    uint8_t* last = chunk.out + chunk.out_len;
+                    chunk.out_len += pad_block(chunk.in + full_blocks * 16, rem, last);
+                    SM4_Core::crypt_block(last, last, rk_);
+                }
+            } else {
+                if (rem) { chunk.ok = false; return; }
+                SM4_Core::crypt_blocks(chunk.in, chunk.out, full_blocks, rk_, false);
+                chunk.out_len = chunk.in_len;
+            }
+            break;
+
+        case Mode::CBC:
+            if (options_.encrypt) {
+                // 单线程按序执行，cbc_state_保存上一块的最后一个密文分组
+                size_t total = full_blocks;
+                if (chunk.final) {
+                    pad_block(chunk.in + full_blocks * 16, rem, chunk.in + full_blocks * 16);
+                    ++total;
+                }
+                for (size_t b = 0; b < total; ++b) {
+                    uint8_t* block = chunk.out + b * 16;
+                    xor_128(block, chunk.in + b * 16, cbc_state_);
+                    SM4_Core::crypt_block(block, block, rk_);
+                    memcpy(cbc_state_, block, 16);
+                }
+                chunk.out_len = total * 16;
+            } else {
+                // 解密各分组互不依赖，整块用多分组内核解密后再异或前一个密文分组
+                if (rem) { chunk.ok = false; return; }
+                SM4_Core::crypt_blocks(chunk.in, chunk.out, full_blocks, rk_, false);
+                for (size_t b = 0; b < full_blocks; ++b) {
+                    xor_128(chunk.out + b * 16, chunk.out + b * 16, b ? chunk.in + (b - 1) * 16 : chunk.prev_block);
+                }
+                chunk.out_len = chunk.in_len;
+            }
+            break;
+        }
+
+        if (chunk.final && !options_.encrypt) {
+            size_t len = strip_padding(chunk.out, chunk.out_len);
+            if (len == SIZE_MAX) {
+                chunk.ok = false;
+                return;
+            }
+            chunk.out_len = len;
+        }
+    }
+};
+
+#ifdef __linux__
+// io_uring后端（仅CTR/GCM、输入输出均为普通文件）：
+// 注册缓冲区与文件描述符后保持多个READ_FIXED/WRITE_FIXED在途，读完成的缓冲区直接交给工作线程原地加解密，
+// 加解密完成后由工作线程提交写请求，全程不拷贝数据；GCM的GHASH按块独立计算后用H的幂按序合并
+class UringPipeline {
+public:
+    static constexpr size_t SLOT_BYTES = 256 * 1024;  // 每个注册缓冲区大小（16的倍数）
+
+    UringPipeline(const Options& options, FILE* input, FILE* output)
+        : options_(options), in_fd_(fileno(input)), out_fd_(fileno(output)),
+          slot_count_(options.threads * 2 + 4), work_(slot_count_) {
+        SM4_Core::expand_key(options.key, rk_);
+    }
+
+    ~UringPipeline() {
+        if (ring_fd_ >= 0) close(ring_fd_);
+        if (sq_ptr_ != MAP_FAILED) munmap(sq_ptr_, sq_ring_bytes_);
+        if (cq_ptr_ != MAP_FAILED && cq_ptr_ != sq_ptr_) munmap(cq_ptr_, cq_ring_bytes_);
+        if (sqes_ != MAP_FAILED) munmap(sqes_, sqe_bytes_);
+        for (Slot& slot : slots_) {
+            ::operator delete(slot.buffer, align_val_t(BUFFER_ALIGN));
+        }
+    }
+
+    // 建立ring并注册缓冲区和文件，内核不支持或受限时返回false（调用方改用线程流水线）
+    bool setup() {
+        io_uring_params params;
+        memset(&params, 0, sizeof(params));
+        unsigned entries = 1;
+        while (entries < 2 * slot_count_) entries <<= 1;
+        ring_fd_ = static_cast<int>(syscall(__NR_io_uring_setup, entries, &params));
+        if (ring_fd_ < 0) return false;
+
+        sq_ring_bytes_ = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+        cq_ring_bytes_ = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+        bool single_mmap = params.features & IORING_FEAT_SINGLE_MMAP;
+        if (single_mmap) {
+            sq_ring_bytes_ = cq_ring_bytes_ = max(sq_ring_bytes_, cq_ring_bytes_);
+        }
+        sq_ptr_ = mmap(nullptr, sq_ring_bytes_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                       ring_fd_, IORING_OFF_SQ_RING);
+        if (sq_ptr_ == MAP_FAILED) return false;
+        cq_ptr_ = single_mmap ? sq_ptr_ : mmap(nullptr, cq_ring_bytes_, PROT_READ | PROT_WRITE,
+                                               MAP_SHARED | MAP_POPULATE, ring_fd_, IORING_OFF_CQ_RING);
+        if (cq_ptr_ == MAP_FAILED) return false;
+        sqe_bytes_ = params.sq_entries * sizeof(io_uring_sqe);
+        sqes_ = mmap(nullptr, sqe_bytes_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                     ring_fd_, IORING_OFF_SQES);
+        if (sqes_ == MAP_FAILED) return false;
+
+        uint8_t* sq = static_cast<uint8_t*>(sq_ptr_);
+        uint8_t* cq = static_cast<uint8_t*>(cq_ptr_);
+        sq_tail_ = reinterpret_cast<unsigned*>(sq + params.sq_off.tail);
+        sq_mask_ = *reinterpret_cast<unsigned*>(sq + params.sq_off.ring_mask);
+        sq_array_ = reinterpret_cast<unsigned*>(sq + params.sq_off.array);
+        cq_head_ = reinterpret_cast<unsigned*>(cq + params.cq_off.head);
+        cq_tail_ = reinterpret_cast<unsigned*>(cq + params.cq_off.tail);
+        cq_mask_ = *reinterpret_cast<unsigned*>(cq + params.cq_off.ring_mask);
+        cqes_ = reinterpret_cast<io_uring_cqe*>(cq + params.cq_off.cqes);
+
+        // 注册缓冲区（READ_FIXED/WRITE_FIXED免去每次请求的页面映射）和固定文件
+        vector<iovec> iovecs(slot_count_);
+        slots_.resize(slot_count_);
+        for (size_t i = 0; i < slot_count_; ++i) {
+            slots_[i].buffer = static_cast<uint8_t*>(::operator new(SLOT_BYTES, align_val_t(BUFFER_ALIGN)));
+            iovecs[i].iov_base = slots_[i].buffer;
+            iovecs[i].iov_len = SLOT_BYTES;
+        }
+        if (syscall(__NR_io_uring_register, ring_fd_, IORING_REGISTER_BUFFERS,
+                    iovecs.data(), static_cast<unsigned>(slot_count_)) < 0) {
+            return false;
+        }
+        int fds[2] = { in_fd_, out_fd_ };
+        return syscall(__NR_io_uring_register, ring_fd_, IORING_REGISTER_FILES, fds, 2) >= 0;
+    }
+
+    bool run(const uint8_t* iv) {
+        const size_t iv_len = options_.mode == Mode::GCM ? 12 : 16;
+        const size_t tag_len = options_.mode == Mode::GCM ? 16 : 0;
+        struct stat st;
+        if (fstat(in_fd_, &st) < 0) {
+            fail("cannot stat input");
+            return false;
+        }
+        uint64_t input_size = static_cast<uint64_t>(st.st_size);
+        if (!options_.encrypt && input_size < iv_len + tag_len) {
+            fail("input too short");
+            return false;
+        }
+        total_ = options_.encrypt ? input_size : input_size - iv_len - tag_len;
+        if (options_.mode == Mode::GCM && !gcm_length_ok(total_)) {
+            fail(GCM_TOO_LONG);
+            return false;
+        }
+        in_base_ = options_.encrypt ? 0 : iv_len;
+        out_base_ = options_.encrypt ? iv_len : 0;
+
+        if (options_.mode == Mode::GCM) {
+            uint8_t zero[16] = { 0 };
+            SM4_Core::crypt_block(zero, H_, rk_);
+            memset(J0_, 0, 16);
+            memcpy(J0_, iv, 12);
+            J0_[15] = 1;
+            memcpy(counter0_, J0_, 16);
+            gcm_counter_add(counter0_, 1);
+            gf_pow(H_, SLOT_BYTES / 16, h_slot_power_);
+        } else {
+            memcpy(counter0_, iv, 16);
+        }
+
+        vector<thread> workers;
+        for (unsigned i = 0; i < options_.threads; ++i) {
+            workers.emplace_back(&UringPipeline::worker, this);
+        }
+
+        size_t in_flight = 0;
+        for (size_t i = 0; i < slot_count_ && next_offset_ < total_; ++i) {
+            start_read(i);
+            ++in_flight;
+        }
+
+        // 收割完成事件：读完成交给工作线程，写完成后复用缓冲区继续读
+        while (in_flight > 0) {
+            if (syscall(__NR_io_uring_enter, ring_fd_, 0, 1, IORING_ENTER_GETEVENTS, nullptr, 0) < 0 && errno != EINTR) {
+                fail("io_uring_enter failed");
+                break;
+            }
+            unsigned head = *cq_head_;
+            unsigned tail = __atomic_load_n(cq_tail_, __ATOMIC_ACQUIRE);
+            for (; head != tail; ++head) {
+                const io_uring_cqe& cqe = cqes_[head & cq_mask_];
+                Slot& slot = slots_[cqe.user_data];
+                if (cqe.res <= 0) {
+                    fail(cqe.res == 0 ? "unexpected end of input" : strerror(-cqe.res));
+                    --in_flight;
+                    continue;
+                }
+                slot.done += static_cast<size_t>(cqe.res);
+                if (slot.done < slot.len && !failed_) {
+                    submit(slot.writing, cqe.user_data);   // 短读/短写：继续剩余部分
+                } else if (failed_) {
+                    --in_flight;
+                } else if (!slot.writing) {
+                    work_.push(cqe.user_data);
+                } else if (next_offset_ < total_) {
+                    start_read(cqe.user_data);
+                } else {
+                    --in_flight;
+                }
+            }
+            __atomic_store_n(cq_head_, head, __ATOMIC_RELEASE);
+        }
+
+        work_.close();
+        for (thread& t : workers) {
+            t.join();
+        }
+        if (failed_) return false;
+        return options_.mode == Mode::GCM ? finish_gcm() : true;
+    }
+
+private:
+    struct Slot {
+        uint8_t* buffer = nullptr;
+        uint64_t seq = 0, offset = 0;   // 块序号与数据流偏移
+        size_t len = 0, done = 0;
+        bool writing = false;
+    };
+
+    const Options& options_;
+    int in_fd_, out_fd_;
+    size_t slot_count_;
+    vector<Slot> slots_;
+    BoundedQueue<size_t> work_;
+    atomic<bool> failed_{false};
+
+    int ring_fd_ = -1;
+    void* sq_ptr_ = MAP_FAILED;
+    void* cq_ptr_ = MAP_FAILED;
+    void* sqes_ = MAP_FAILED;
+    size_t sq_ring_bytes_ = 0, cq_ring_bytes_ = 0, sqe_bytes_ = 0;
+    unsigned *sq_tail_ = nullptr, *sq_array_ = nullptr, *cq_head_ = nullptr, *cq_tail_ = nullptr;
+    unsigned sq_mask_ = 0, cq_mask_ = 0;
+    io_uring_cqe* cqes_ = nullptr;
+    mutex submit_mutex_;            // 工作线程与收割线程都会提交SQE
+
+    uint64_t total_ = 0, in_base_ = 0, out_base_ = 0, next_offset_ = 0, next_seq_ = 0;
+    uint32_t rk_[32];
+    uint8_t counter0_[16], H_[16], J0_[16];
+
+    // GCM：各块的GHASH部分和按序合并，Y = Y·H^m ^ S_i
+    mutex ghash_mutex_;
+    map<uint64_t, pair<array<uint8_t, 16>, size_t>> ghash_pending_;
+    uint64_t ghash_next_ = 0;
+    uint8_t ghash_y_[16] = { 0 };
+    uint8_t h_slot_power_[16];
+
+    void fail(const char* message) {
+        if (!failed_.exchange(true)) {
+            cerr << "sm4_file: " << message << endl;
+        }
+    }
+
+    void start_read(size_t index) {
+        Slot& slot = slots_[index];
+        slot.seq = next_seq_++;
+        slot.offset = next_offset_;
+        slot.len = static_cast<size_t>(min<uint64_t>(SLOT_BYTES, total_ - next_offset_));
+        slot.done = 0;
+        slot.writing = false;
+        next_offset_ += slot.len;
+        submit(false, index);
+    }
+
+    // 提交READ_FIXED/WRITE_FIXED，从slot.done处继续
+    void submit(bool write, size_t index) {
+        Slot& slot = slots_[index];
+        lock_guard<mutex> lock(submit_mutex_);
+        unsigned tail = *sq_tail_;
+        unsigned sq_index = tail & sq_mask_;
+        io_uring_sqe& sqe = static_cast<io_uring_sqe*>(sqes_)[sq_index];
+        memset(&sqe, 0, sizeof(sqe));
+        sqe.opcode = write ? IORING_OP_WRITE_FIXED : IORING_OP_READ_FIXED;
+        sqe.flags = IOSQE_FIXED_FILE;
+        sqe.fd = write ? 1 : 0;   // 注册文件表中的下标
+        sqe.addr = reinterpret_cast<uint64_t>(slot.buffer + slot.done);
+        sqe.len = static_cast<uint32_t>(slot.len - slot.done);
+        sqe.off = (write ? out_base_ : in_base_) + slot.offset + slot.done;
+        sqe.buf_index = static_cast<uint16_t>(index);
+        sqe.user_data = index;
+        sq_array_[sq_index] = sq_index;
+        __atomic_store_n(sq_tail_, tail + 1, __ATOMIC_RELEASE);
+        if (syscall(__NR_io_uring_enter, ring_fd_, 1, 0, 0, nullptr, 0) < 0) {
+            fail("io_uring_enter failed");
+        }
+    }
+
+    void worker() {
+        size_t index;
+        while (work_.pop(index)) {
+            Slot& slot = slots_[index];
+            if (options_.mode == Mode::GCM && !options_.encrypt) absorb_ghash(slot);
+            ctr_xor(options_.mode, counter0_, rk_, slot.offset, slot.buffer, slot.buffer, slot.len);
+            if (options_.mode == Mode::GCM && options_.encrypt) absorb_ghash(slot);
+            slot.done = 0;
+            slot.writing = true;
+            submit(true, index);
+        }
+    }
+
+    // 计算本块密文的GHASH部分和，再按块序号合并到总状态
+    void absorb_ghash(const Slot& slot) {
+        GHASH partial;
+        partial.init(H_);
+        partial.update_padded(slot.buffer, slot.len);
+        array<uint8_t, 16> sum;
+        memcpy(sum.data(), partial.Y, 16);
+
+        lock_guard<mutex> lock(ghash_mutex_);
+        ghash_pending_[slot.seq] = { sum, (slot.len + 15) / 16 };
+        for (auto it = ghash_pending_.find(ghash_next_); it != ghash_pending_.end();
+             it = ghash_pending_.find(ghash_next_)) {
+            uint8_t power[16], tmp[16];
+            if (it->second.second == SLOT_BYTES / 16) {
+                memcpy(power, h_slot_power_, 16);
+            } else {
+                gf_pow(H_, it->second.second, power);
+            }
+            gf_mul(ghash_y_, power, tmp);
+            xor_128(ghash_y_, tmp, it->second.first.data());
+            ghash_pending_.erase(it);
+            ++ghash_next_;
+        }
+    }
+
+    // 合并长度块得到TAG：加密时追加在输出末尾，解密时与输入末尾的TAG比较
+    bool finish_gcm() {
+        GHASH ghash;
+        ghash.init(H_);
+        memcpy(ghash.Y, ghash_y_, 16);
+        uint8_t tag[16], s[16];
+        ghash.finalize(0, total_, tag);
+        SM4_Core::crypt_block(J0_, s, rk_);
+        xor_128(tag, tag, s);
+
+        if (options_.encrypt) {
+            if (pwrite(out_fd_, tag, 16, static_cast<off_t>(out_base_ + total_)) != 16) {
+                fail("write error");
+                return false;
+            }
+            return true;
+        }
+        uint8_t expected[16];
+        if (pread(in_fd_, expected, 16, static_cast<off_t>(in_base_ + total_)) != 16) {
+            fail("read error");
+            return false;
+        }
+        uint8_t diff = 0;
+        for (int i = 0; i < 16; ++i) diff |= tag[i] ^ expected[i];
+        if (diff) fail("authentication failed");
+        return diff == 0;
+    }
+};
+#endif
+
+bool parse_hex(const string& text, vector<uint8_t>& bytes) {
+    if (text.size() % 2) return false;
+    bytes.clear();
+    for (size_t i = 0; i < text.size(); i += 2) {
+        int value = 0;
+        for (size_t j = i; j < i + 2; ++j) {
+            char c = text[j];
+            int digit = (c >= '0' && c <= '9') ? c - '0' :
+                        (c >= 'a' && c <= 'f') ? c - 'a' + 10 :
+                        (c >= 'A' && c <= 'F') ? c - 'A' + 10 : -1;
+            if (digit < 0) return false;
+            value = value * 16 + digit;
+        }
+        bytes.push_back(static_cast<uint8_t>(value));
+    }
+    return true;
+}
+
+void print_usage() {
+    cerr << "Usage: sm4_file <enc|dec> -k <32 hex digits> [-m ecb|cbc|ctr|gcm] [-iv <hex>]\n"
+            "                [-i <input>] [-o <output>] [-t <threads>] [-u]\n"
+            "  Default mode is gcm; '-' (default) means stdin/stdout.\n"
+            "  Encryption writes IV || data || tag; a random IV is generated when -iv is omitted.\n"
+            "  ECB/CBC use PKCS#7 padding. GCM decryption streams plaintext out and reports\n"
+            "  a failed tag check with exit status 1 (a regular output file is removed).\n"
+            "  GCM input is limited to 2^32-2 blocks (about 64 GiB) per message.\n"
+            "  -u uses the Linux io_uring backend (ctr/gcm, regular files only).\n";
+}
+
+bool parse_options(int argc, char* argv[], Options& options) {
+    if (argc < 2) return false;
+    string command = argv[1];
+    if (command == "enc") options.encrypt = true;
+    else if (command == "dec") options.encrypt = false;
+    else return false;
+
+    for (int i = 2; i < argc; ++i) {
+        string arg = argv[i];
+        if (arg == "-u") {
+            options.use_uring = true;
+            continue;
+        }
+        if (i + 1 >= argc) return false;
+        string value = argv[++i];
+        vector<uint8_t> bytes;
+        if (arg == "-k") {
+            if (!parse_hex(value, bytes) || bytes.size() != 16) return false;
+            memcpy(options.key, bytes.data(), 16);
+            options.has_key = true;
+        } else if (arg == "-m") {
+            if (value == "ecb") options.mode = Mode::ECB;
+            else if (value == "cbc") options.mode = Mode::CBC;
+            else if (value == "ctr") options.mode = Mode::CTR;
+            else if (value == "gcm") options.mode = Mode::GCM;
+            else return false;
+        } else if (arg == "-iv") {
+            if (!parse_hex(value, options.iv)) return false;
+        } else if (arg == "-i") {
+            options.input = value;
+        } else if (arg == "-o") {
+            options.output = value;
+        } else if (arg == "-t") {
+            options.threads = static_cast<unsigned>(max(1, atoi(value.c_str())));
+        } else {
+            return false;
+        }
+    }
+    // io_uring后端只支持CTR/GCM，且需要可按偏移读写的普通文件
+    if (options.use_uring && (options.mode == Mode::ECB || options.mode == Mode::CBC ||
+                              options.input == "-" || options.output == "-")) {
+        return false;
+    }
+    return options.has_key;
+}
+
+int main(int argc, char* argv[]) {
+    Options options;
+    if (!parse_options(argc, argv, options)) {
+        print_usage();
+        return 2;
+    }
+
+    size_t iv_len = options.mode == Mode::ECB ? 0 : options.mode == Mode::GCM ? 12 : 16;
+    if (!options.iv.empty() && (!options.encrypt || options.iv.size() != iv_len)) {
+        cerr << "sm4_file: -iv must be " << iv_len << " bytes and is only used for encryption" << endl;
+        return 2;
+    }
+
+#ifdef _WIN32
+    _setmode(_fileno(stdin), _O_BINARY);
+    _setmode(_fileno(stdout), _O_BINARY);
+#endif
+    FILE* input = options.input == "-" ? stdin : fopen(options.input.c_str(), "rb");
+    if (!input) {
+        cerr << "sm4_file: cannot open " << options.input << endl;
+        return 1;
+    }
+    FILE* output = options.output == "-" ? stdout : fopen(options.output.c_str(), "wb");
+    if (!output) {
+        cerr << "sm4_file: cannot open " << options.output << endl;
+        return 1;
+    }
+
+    // IV：加密时写在输出开头，解密时从输入开头读出
+    uint8_t iv[16] = { 0 };
+    bool ok = gcm_input_fits(options, input);
+    if (!ok) {
+        cerr << "sm4_file: " << GCM_TOO_LONG << endl;
+    } else if (options.encrypt) {
+        if (options.iv.empty()) {
+            SM4CtrDrbg::thread_instance().fill(iv, iv_len);
+        } else {
+            memcpy(iv, options.iv.data(), iv_len);
+        }
+        ok = fwrite(iv, 1, iv_len, output) == iv_len;
+    } else {
+        ok = read_full(input, iv, iv_len) == iv_len;
+        if (!ok) cerr << "sm4_file: input too short to contain an IV" << endl;
+    }
+
+    if (ok) {
+        bool done = false;
+#ifdef __linux__
+        if (options.use_uring && fflush(output) == 0) {
+            UringPipeline uring(options, input, output);
+            if (uring.setup()) {
+                ok = uring.run(iv);
+                done = true;
+            } else {
+                cerr << "sm4_file: io_uring unavailable, falling back to the thread pipeline" << endl;
+            }
+        }
+#endif
+        if (!done) {
+            FilePipeline pipeline(options, input, output);
+            ok = pipeline.run(iv);
+        }
+    }
+
+    if (input != stdin) fclose(input);
+    if (output != stdout) {
+        ok = (fclose(output) == 0) && ok;
+        if (!ok) remove(options.output.c_str());
+    } else {
+        ok = (fflush(output) == 0) && ok;
+    }
+    return ok ? 0 : 1;
+}
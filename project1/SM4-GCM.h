@@ -0,0 +1,510 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include "SM4-Core.h"
+
+// SM4-GCM（GHASH + CTR），供SM4-GCM.cpp测试程序和文件加密工具共用
+
+// --- 128位异或 ---
+inline void xor_128(uint8_t out[16], const uint8_t a[16], const uint8_t b[16]) {
+    for (int i = 0; i < 16; ++i) out[i] = a[i] ^ b[i];
+}
+
+// --- GF(2^128)逐位乘法（GHASH定义的参考实现）---
+inline void gf_mul(const uint8_t X[16], const uint8_t Y[16], uint8_t Z[16]) {
+    uint8_t V[16];
+    memcpy(V, Y, 16);
+    memset(Z, 0, 16);
+
+    for (int i = 0; i < 128; ++i) {
+        int byte = i / 8;
+        int bit = 7 - (i % 8);
+        if ((X[byte] >> bit) & 1) {
+            for (int j = 0; j < 16; ++j)
+                Z[j] ^= V[j];
+        }
+        // V右移一位（乘x）
+        bool lsb = (V[15] & 1) != 0;
+        for (int j = 15; j > 0; --j)
+            V[j] = (V[j] >> 1) | ((V[j - 1] & 1) << 7);
+        V[0] >>= 1;
+        if (lsb) {
+            // 约减多项式 x^128 + x^7 + x^2 + x + 1
+            V[0] ^= 0xe1;
+        }
+    }
+}
+
+// --- H的n次幂（平方乘），用于合并分段计算的GHASH：Y = Y·H^m ^ S ---
+inline void gf_pow(const uint8_t H[16], uint64_t n, uint8_t out[16]) {
+    uint8_t result[16] = { 0 }, base[16], tmp[16];
+    result[0] = 0x80;   // GHASH比特序下的乘法单位元
+    memcpy(base, H, 16);
+    for (; n; n >>= 1) {
+        if (n & 1) {
+            gf_mul(result, base, tmp);
+            memcpy(result, tmp, 16);
+        }
+        gf_mul(base, base, tmp);
+        memcpy(base, tmp, 16);
+    }
+    memcpy(out, result, 16);
+}
+
+// --- GHASH：4比特查表乘法（Shoup方法），每个H预计算16项 ---
+struct GHASH {
+    uint8_t H[16];
+    uint8_t Y[16]; // 当前状态
+    uint64_t HL[16], HH[16]; // i·H 的低/高64位
+
+    void init(const uint8_t H_in[16]) {
+        memcpy(H, H_in, 16);
+        memset(Y, 0, 16);
+
+        uint64_t vh = (static_cast<uint64_t>(SM4_Core::load_be32(H)) << 32) | SM4_Core::load_be32(H + 4);
+        uint64_t vl = (static_cast<uint64_t>(SM4_Core::load_be32(H + 8)) << 32) | SM4_Core::load_be32(H + 12);
+        HL[0] = HH[0] = 0;
+        HL[8] = vl;
+        HH[8] = vh;
+        for (int i = 4; i > 0; i >>= 1) {
+            uint64_t t = (vl & 1) * 0xe1000000ULL;
+            vl = (vh << 63) | (vl >> 1);
+            vh = (vh >> 1) ^ (t << 32);
+            HL[i] = vl;
+            HH[i] = vh;
+        }
+        for (int i = 2; i <= 8; i *= 2) {
+            for (int j = 1; j < i; ++j) {
+                HH[i + j] = HH[i] ^ HH[j];
+                HL[i + j] = HL[i] ^ HL[j];
+            }
+        }
+    }
+
+    // Y = Y·H
+    void multiply_h() {
+        static const uint64_t LAST4[16] = {
+            0x0000, 0x1c20, 0x3840, 0x2460, 0x7080, 0x6ca0, 0x48c0, 0x54e0,
+            0xe100, 0xfd20, 0xd940, 0xc560, 0x9180, 0x8da0, 0xa9c0, 0xb5e0
+        };
+        uint8_t lo = Y[15] & 0xf;
+        uint64_t zh = HH[lo], zl = HL[lo];
+        for (int i = 15; i >= 0; --i) {
+            lo = Y[i] & 0xf;
+            uint8_t hi = (Y[i] >> 4) & 0xf;
+            if (i != 15) {
+                uint8_t rem = zl & 0xf;
+                zl = (zh << 60) | (zl >> 4);
+                zh = (zh >> 4) ^ (LAST4[rem] << 48) ^ HH[lo];
+                zl ^= HL[lo];
+            }
+            uint8_t rem = zl & 0xf;
+            zl = (zh << 60) | (zl >> 4);
+            zh = (zh >> 4) ^ (LAST4[rem] << 48) ^ HH[hi];
+            zl ^= HL[hi];
+        }
+        SM4_Core::store_be32(Y, static_cast<uint32_t>(zh >> 32));
+        SM4_Core::store_be32(Y + 4, static_cast<uint32_t>(zh));
+        SM4_Core::store_be32(Y + 8, static_cast<uint32_t>(zl >> 32));
+        SM4_Core::store_be32(Y + 12, static_cast<uint32_t>(zl));
+    }
+
+    void update(const uint8_t data[16]) {
+        xor_128(Y, Y, data);
+        multiply_h();
+    }
+
+    // 吸收任意长度数据，最后不足16字节的部分补零
+    void update_padded(const uint8_t* data, size_t len) {
+        size_t blocks = len / 16;
+        for (size_t i = 0; i < blocks; ++i)
+            update(data + i * 16);
+        size_t rem = len % 16;
+        if (rem) {
+            uint8_t last[16] = { 0 };
+            memcpy(last, data + blocks * 16, rem);
+            update(last);
+        }
+    }
+
+    // 吸收长度块并输出GHASH值
+    // A_len、C_len单位为字节，按GCM规定写成比特长度
+    void finalize(uint64_t A_len, uint64_t C_len, uint8_t tag[16]) {
+        uint8_t len_block[16];
+        uint64_t alen_bits = A_len * 8ULL;
+        uint64_t clen_bits = C_len * 8ULL;
+        SM4_Core::store_be32(len_block, static_cast<uint32_t>(alen_bits >> 32));
+        SM4_Core::store_be32(len_block + 4, static_cast<uint32_t>(alen_bits));
+        SM4_Core::store_be32(len_block + 8, static_cast<uint32_t>(clen_bits >> 32));
+        SM4_Core::store_be32(len_block + 12, static_cast<uint32_t>(clen_bits));
+        update(len_block);
+        memcpy(tag, Y, 16);
+    }
+};
+
+// --- GCM计数器：低32位加n（inc32）---
+inline void gcm_counter_add(uint8_t counter[16], uint32_t n) {
+    SM4_Core::store_be32(counter + 12, SM4_Core::load_be32(counter + 12) + n);
+}
+
+// --- 单条消息的明文/密文长度上限（SP 800-38D）：数据从J0+1开始按inc32计数，
+// 超过2^32-2个分组后低32位回绕，会重用J0及之前的计数器 ---
+constexpr uint64_t GCM_MAX_TEXT_BYTES = ((uint64_t(1) << 32) - 2) * 16;
+
+inline bool gcm_length_ok(uint64_t text_len) {
+    return text_len <= GCM_MAX_TEXT_BYTES;
+}
+
+// --- 计数器模式 ---
+// counter为第一个分组使用的计数器值，按inc32递增；keystream分批由多分组内核生成
+inline void ctr_crypt(const uint8_t counter[16], const uint32_t rk[32], const uint8_t* in, uint8_t* out, size_t len) {
+    constexpr size_t BATCH_BLOCKS = 8;
+    uint8_t ctr[16];
+    memcpy(ctr, counter, 16);
+    uint8_t keystream[BATCH_BLOCKS * 16];
+
+    while (len > 0) {
+        size_t blocks = (len + 15) / 16;
+        if (blocks > BATCH_BLOCKS) blocks = BATCH_BLOCKS;
+        for (size_t b = 0; b < blocks; ++b) {
+            memcpy(keystream + b * 16, ctr, 16);
+            gcm_counter_add(ctr, 1);
+        }
+        SM4_Core::crypt_blocks(keystream, keystream, blocks, rk);
+
+        size_t n = blocks * 16 < len ? blocks * 16 : len;
+        for (size_t i = 0; i < n; ++i)
+            out[i] = in[i] ^ keystream[i];
+        in += n;
+        out += n;
+        len -= n;
+    }
+}
+
+// --- 由密钥得到轮密钥和 H = SM4_Encrypt(0) ---
+inline void gcm_setup(const uint8_t key[16], uint32_t rk[32], uint8_t H[16]) {
+    SM4_Core::expand_key(key, rk);
+    uint8_t zero_block[16] = { 0 };
+    SM4_Core::crypt_block(zero_block, H, rk);
+}
+
+// --- 预计算的密钥上下文：轮密钥、H、GHASH查表，可选的 H^GCM_FOLD_BLOCKS（合并分段GHASH用）---
+// 同一密钥反复加解密时只需建立一次（见SM4-KeyCache.h）
+constexpr size_t GCM_FOLD_BLOCKS = 4096;
+
+struct GcmKey {
+    uint32_t rk[32];
+    uint8_t H[16];
+    GHASH ghash;            // Y为0，查表已就绪
+    uint8_t H_fold[16];     // H^GCM_FOLD_BLOCKS，has_fold为true时有效
+    bool has_fold;
+};
+
+inline void gcm_key_init(GcmKey& ctx, const uint8_t key[16], bool with_fold = false) {
+    gcm_setup(key, ctx.rk, ctx.H);
+    ctx.ghash.init(ctx.H);
+    ctx.has_fold = with_fold;
+    if (with_fold) {
+        gf_pow(ctx.H, GCM_FOLD_BLOCKS, ctx.H_fold);
+    } else {
+        memset(ctx.H_fold, 0, 16);
+    }
+}
+
+// 清零不会被编译器当作死存储删掉
+inline void gcm_wipe(void* p, size_t len) {
+    volatile uint8_t* bytes = static_cast<volatile uint8_t*>(p);
+    while (len--) *bytes++ = 0;
+}
+
+inline void gcm_key_wipe(GcmKey& ctx) {
+    volatile uint8_t* p = reinterpret_cast<volatile uint8_t*>(&ctx);
+    for (size_t i = 0; i < sizeof(ctx); ++i) p[i] = 0;
+}
+
+inline void gcm_make_j0(const uint8_t iv[12], uint8_t J0[16]) {
+    memset(J0, 0, 16);
+    memcpy(J0, iv, 12);
+    J0[15] = 1;
+}
+
+// --- 计算TAG = GHASH(AAD, C) ^ SM4(J0) ---
+inline void gcm_compute_tag(const GcmKey& ctx, const uint8_t J0[16],
+    const uint8_t* aad, size_t aad_len,
+    const uint8_t* ciphertext, size_t ct_len,
+    uint8_t tag[16]) {
+    GHASH ghash = ctx.ghash;
+    ghash.update_padded(aad, aad_len);
+    ghash.update_padded(ciphertext, ct_len);
+    ghash.finalize(aad_len, ct_len, tag);
+
+    uint8_t s[16];
+    SM4_Core::crypt_block(J0, s, ctx.rk);
+    xor_128(tag, tag, s);
+}
+
+// --- SM4-GCM加密（使用预计算的密钥上下文）---
+inline void sm4_gcm_encrypt(const GcmKey& ctx, const uint8_t iv[12],
+    const uint8_t* plaintext, size_t pt_len,
+    const uint8_t* aad, size_t aad_len,
+    uint8_t* ciphertext, uint8_t tag[16]) {
+
+    // 计数器初值 J0 = IV || 0x00000001，从 J0+1 开始加密数据
+    uint8_t J0[16], ctr0[16];
+    gcm_make_j0(iv, J0);
+    memcpy(ctr0, J0, 16);
+    gcm_counter_add(ctr0, 1);
+    ctr_crypt(ctr0, ctx.rk, plaintext, ciphertext, pt_len);
+
+    gcm_compute_tag(ctx, J0, aad, aad_len, ciphertext, pt_len, tag);
+}
+
+// --- SM4-GCM解密（使用预计算的密钥上下文）---
+// 返回true表示认证通过，否则返回false
+inline bool sm4_gcm_decrypt(const GcmKey& ctx, const uint8_t iv[12],
+    const uint8_t* ciphertext, size_t ct_len,
+    const uint8_t* aad, size_t aad_len,
+    const uint8_t tag[16],
+    uint8_t* plaintext) {
+
+    uint8_t J0[16], ctr0[16], calc_tag[16];
+    gcm_make_j0(iv, J0);
+    gcm_compute_tag(ctx, J0, aad, aad_len, ciphertext, ct_len, calc_tag);
+
+    memcpy(ctr0, J0, 16);
+    gcm_counter_add(ctr0, 1);
+    ctr_crypt(ctr0, ctx.rk, ciphertext, plaintext, ct_len);
+
+    // 常数时间比较TAG
+    uint8_t diff = 0;
+    for (int i = 0; i < 16; ++i)
+        diff |= calc_tag[i] ^ tag[i];
+    return diff == 0;
+}
+
+// --- SM4-GCM加密 ---
+inline void sm4_gcm_encrypt(const uint8_t key[16], const uint8_t iv[12],
+    const uint8_t* plaintext, size_t pt_len,
+    const uint8_t* aad, size_t aad_len,
+    uint8_t* ciphertext, uint8_t tag[16]) {
+    GcmKey ctx;
+    gcm_key_init(ctx, key);
+    sm4_gcm_encrypt(ctx, iv, plaintext, pt_len, aad, aad_len, ciphertext, tag);
+    gcm_key_wipe(ctx);
+}
+
+// --- SM4-GCM解密 ---
+// 返回true表示认证通过，否则返回false
+inline bool sm4_gcm_decrypt(const uint8_t key[16], const uint8_t iv[12],
+    const uint8_t* ciphertext, size_t ct_len,
+    const uint8_t* aad, size_t aad_len,
+    const uint8_t tag[16],
+    uint8_t* plaintext) {
+    GcmKey ctx;
+    gcm_key_init(ctx, key);
+    bool ok = sm4_gcm_decrypt(ctx, iv, ciphertext, ct_len, aad, aad_len, tag, plaintext);
+    gcm_key_wipe(ctx);
+    return ok;
+}
+
+// --- 分散/聚集（iovec）接口 ---
+// 分片描述，字段与POSIX struct iovec一致
+struct sm4_iovec {
+    void* iov_base;
+    size_t iov_len;
+};
+
+// 流式GCM状态：跨分片保存不足16字节的GHASH输入和未用完的密钥流
+// 含轮密钥、GHASH查表和密钥流，析构时清零，所以不允许复制
+struct GcmStream {
+    uint32_t rk[32];
+    uint8_t J0[16];
+    uint8_t counter[16];     // 下一个密钥流分组的计数器
+    GHASH ghash;
+    uint8_t pending[16];     // 尚未凑满一个分组的GHASH输入
+    size_t pending_len;
+    uint8_t keystream[16];   // 当前密钥流分组，ks_pos之前的字节已用
+    size_t ks_pos;
+    uint64_t aad_len, text_len;
+
+    GcmStream() = default;
+    GcmStream(const GcmStream&) = delete;
+    GcmStream& operator=(const GcmStream&) = delete;
+
+    ~GcmStream() {
+        wipe();
+    }
+
+    void wipe() {
+        gcm_wipe(this, sizeof(*this));
+    }
+
+    void start(const uint8_t key[16], const uint8_t iv[12]) {
+        uint8_t H[16];
+        gcm_setup(key, rk, H);
+        ghash.init(H);
+        gcm_wipe(H, 16);
+        gcm_make_j0(iv, J0);
+        memcpy(counter, J0, 16);
+        gcm_counter_add(counter, 1);
+        pending_len = 0;
+        ks_pos = 16;
+        aad_len = text_len = 0;
+    }
+
+    void absorb(const uint8_t* data, size_t len) {
+        if (pending_len) {
+            size_t n = 16 - pending_len < len ? 16 - pending_len : len;
+            memcpy(pending + pending_len, data, n);
+            pending_len += n;
+            data += n;
+            len -= n;
+            if (pending_len < 16) return;
+            ghash.update(pending);
+            pending_len = 0;
+        }
+        size_t blocks = len / 16;
+        for (size_t i = 0; i < blocks; ++i)
+            ghash.update(data + i * 16);
+        pending_len = len % 16;
+        memcpy(pending, data + blocks * 16, pending_len);
+    }
+
+    // AAD与密文各自补零到分组边界
+    void pad() {
+        if (pending_len) {
+            memset(pending + pending_len, 0, 16 - pending_len);
+            ghash.update(pending);
+            pending_len = 0;
+        }
+    }
+
+    void add_aad(const uint8_t* data, size_t len) {
+        absorb(data, len);
+        aad_len += len;
+    }
+
+    // 计数器模式异或一个分片，接着上一个分片剩下的密钥流继续
+    void apply_keystream(const uint8_t* in, uint8_t* out, size_t len) {
+        while (len > 0 && ks_pos < 16) {
+            *out++ = *in++ ^ keystream[ks_pos++];
+            --len;
+        }
+        size_t blocks = len / 16;
+        if (blocks) {
+            ctr_crypt(counter, rk, in, out, blocks * 16);
+            gcm_counter_add(counter, static_cast<uint32_t>(blocks));
+            in += blocks * 16;
+            out += blocks * 16;
+            len -= blocks * 16;
+        }
+        if (len) {
+            SM4_Core::crypt_block(counter, keystream, rk);
+            gcm_counter_add(counter, 1);
+            for (ks_pos = 0; ks_pos < len; ++ks_pos)
+                out[ks_pos] = in[ks_pos] ^ keystream[ks_pos];
+        }
+    }
+
+    // 加解密一个分片；GHASH总是吸收密文，in与out可以相同
+    void crypt(const uint8_t* in, uint8_t* out, size_t len, bool encrypt) {
+        if (!encrypt) absorb(in, len);
+        apply_keystream(in, out, len);
+        if (encrypt) absorb(out, len);
+        text_len += len;
+    }
+
+    void finish(uint8_t tag[16]) {
+        pad();
+        ghash.finalize(aad_len, text_len, tag);
+        uint8_t s[16];
+        SM4_Core::crypt_block(J0, s, rk);
+        xor_128(tag, tag, s);
+        gcm_wipe(s, 16);
+    }
+};
+
+inline size_t iovec_total(const sm4_iovec* iov, size_t count) {
+    size_t total = 0;
+    for (size_t i = 0; i < count; ++i)
+        total += iov[i].iov_len;
+    return total;
+}
+
+// 按输入、输出两组分片的边界切段，逐段调用fn(in, out, len)
+template <typename Fn>
+inline void for_each_iovec_segment(const sm4_iovec* in, size_t in_count,
+    const sm4_iovec* out, size_t out_count, Fn fn) {
+    size_t i = 0, o = 0, in_off = 0, out_off = 0;
+    while (i < in_count && o < out_count) {
+        size_t n = in[i].iov_len - in_off;
+        if (out[o].iov_len - out_off < n) n = out[o].iov_len - out_off;
+        fn(static_cast<const uint8_t*>(in[i].iov_base) + in_off,
+           static_cast<uint8_t*>(out[o].iov_base) + out_off, n);
+        in_off += n;
+        out_off += n;
+        if (in_off == in[i].iov_len) { ++i; in_off = 0; }
+        if (out_off == out[o].iov_len) { ++o; out_off = 0; }
+    }
+}
+
+inline void gcm_absorb_aad(GcmStream& stream, const sm4_iovec* aad, size_t aad_count) {
+    for (size_t i = 0; i < aad_count; ++i)
+        stream.add_aad(static_cast<const uint8_t*>(aad[i].iov_base), aad[i].iov_len);
+    stream.pad();
+}
+
+// --- SM4-GCM分片加密 ---
+// 明文、密文、AAD均可为任意切分的分片链，无需先拼接；输出分片总长度不足时返回false
+inline bool sm4_gcm_encryptv(const uint8_t key[16], const uint8_t iv[12],
+    const sm4_iovec* plaintext, size_t pt_count,
+    const sm4_iovec* aad, size_t aad_count,
+    const sm4_iovec* ciphertext, size_t ct_count,
+    uint8_t tag[16]) {
+
+    if (iovec_total(ciphertext, ct_count) < iovec_total(plaintext, pt_count))
+        return false;
+
+    GcmStream stream;
+    stream.start(key, iv);
+    gcm_absorb_aad(stream, aad, aad_count);
+    for_each_iovec_segment(plaintext, pt_count, ciphertext, ct_count,
+        [&stream](const uint8_t* in, uint8_t* out, size_t len) { stream.crypt(in, out, len, true); });
+    stream.finish(tag);
+    return true;
+}
+
+// --- SM4-GCM分片解密 ---
+// 先对密文分片计算TAG，认证通过后才写出明文；认证失败或输出不足时返回false
+inline bool sm4_gcm_decryptv(const uint8_t key[16], const uint8_t iv[12],
+    const sm4_iovec* ciphertext, size_t ct_count,
+    const sm4_iovec* aad, size_t aad_count,
+    const uint8_t tag[16],
+    const sm4_iovec* plaintext, size_t pt_count) {
+
+    if (iovec_total(plaintext, pt_count) < iovec_total(ciphertext, ct_count))
+        return false;
+
+    GcmStream stream;
+    stream.start(key, iv);
+    gcm_absorb_aad(stream, aad, aad_count);
+    for (size_t i = 0; i < ct_count; ++i) {
+        stream.absorb(static_cast<const uint8_t*>(ciphertext[i].iov_base), ciphertext[i].iov_len);
+        stream.text_len += ciphertext[i].iov_len;
+    }
+    uint8_t calc_tag[16];
+    stream.finish(calc_tag);
+
+    uint8_t diff = 0;
+    for (int i = 0; i < 16; ++i)
+        diff |= calc_tag[i] ^ tag[i];
+    if (diff != 0)
+        return false;
+
+    // 认证通过后第二遍只做计数器模式解密
+    for_each_iovec_segment(ciphertext, ct_count, plaintext, pt_count,
+        [&stream](const uint8_t* in, uint8_t* out, size_t len) { stream.apply_keystream(in, out, len); });
+    return true;
+}
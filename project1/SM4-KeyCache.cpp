@@ -0,0 +1,130 @@
+#include <iostream>
+#include <vector>
+#include <thread>
+#include <chrono>
+#include <random>
+#include <cmath>
+#include "SM4-KeyCache.h"
+using namespace std;
+
+// --- 测试 ---
+
+void tenant_key(uint32_t tenant, uint8_t key[16]) {
+    for (int i = 0; i < 16; ++i) key[i] = static_cast<uint8_t>((tenant >> ((i % 4) * 8)) ^ (i * 29));
+}
+
+// 缓存的上下文与一次性接口结果一致，LRU淘汰最久未用的条目，被淘汰的上下文在持有者手里仍可用
+void test_cache_correctness() {
+    cout << "=== SM4-GCM Key Context Cache Test ===\n";
+    SM4KeyCache cache(4, 1);
+    uint8_t key[16], iv[12] = { 0 }, tag[16], cached_tag[16];
+    vector<uint8_t> msg(100000, 0x42), ct(msg.size()), cached_ct(msg.size()), back(msg.size());
+
+    bool ok = true;
+    for (uint32_t t = 0; t < 4; ++t) {
+        tenant_key(t, key);
+        SM4KeyCache::Context ctx = cache.get(key);
+        sm4_gcm_encrypt(key, iv, msg.data(), msg.size(), iv, sizeof(iv), ct.data(), tag);
+        sm4_gcm_encrypt(*ctx, iv, msg.data(), msg.size(), iv, sizeof(iv), cached_ct.data(), cached_tag);
+        ok = ok && ct == cached_ct && memcmp(tag, cached_tag, 16) == 0;
+        ok = ok && sm4_gcm_decrypt(*ctx, iv, ct.data(), ct.size(), iv, sizeof(iv), tag, back.data()) && back == msg;
+    }
+    cout << "Cached context matches one-shot API " << (ok ? "Passed" : "Failed") << endl;
+
+    // 持有租户1的上下文后依次访问0、2、3，租户1成为最久未用，插入租户4时被淘汰
+    tenant_key(1, key);
+    SM4KeyCache::Context evicted = cache.get(key);
+    for (uint32_t t : { 0, 2, 3, 4 }) {
+        tenant_key(t, key);
+        cache.get(key);
+    }
+    uint64_t misses = cache.misses();
+    tenant_key(0, key);
+    cache.get(key);
+    bool lru = cache.misses() == misses && cache.evictions() == 1;
+    tenant_key(1, key);
+    lru = lru && cache.get(key) != evicted && cache.misses() == misses + 1 && cache.size() == 4;
+
+    // 淘汰后仍持有的上下文有效
+    tenant_key(1, key);
+    sm4_gcm_encrypt(key, iv, msg.data(), 64, nullptr, 0, ct.data(), tag);
+    sm4_gcm_encrypt(*evicted, iv, msg.data(), 64, nullptr, 0, cached_ct.data(), cached_tag);
+    lru = lru && memcmp(ct.data(), cached_ct.data(), 64) == 0 && memcmp(tag, cached_tag, 16) == 0;
+    cout << "LRU eviction " << (lru ? "Passed" : "Failed") << endl;
+}
+
+// 多线程并发访问同一缓存
+void test_cache_concurrency() {
+    SM4KeyCache cache(256);
+    bool ok = true;
+    mutex ok_mutex;
+    vector<thread> threads;
+    for (int t = 0; t < 4; ++t) {
+        threads.emplace_back([&, t] {
+            mt19937 rng(t);
+            uint8_t key[16], iv[12] = { 1 }, tag[16], expected_tag[16], ct[48], expected[48];
+            const uint8_t msg[48] = { 0 };
+            bool local = true;
+            for (int i = 0; i < 20000; ++i) {
+                tenant_key(rng() % 1000, key);
+                SM4KeyCache::Context ctx = cache.get(key);
+                sm4_gcm_encrypt(*ctx, iv, msg, sizeof(msg), nullptr, 0, ct, tag);
+                if (i % 64 == 0) {
+                    sm4_gcm_encrypt(key, iv, msg, sizeof(msg), nullptr, 0, expected, expected_tag);
+                    local = local && memcmp(ct, expected, sizeof(ct)) == 0 && memcmp(tag, expected_tag, 16) == 0;
+                }
+            }
+            lock_guard<mutex> lock(ok_mutex);
+            ok = ok && local;
+        });
+    }
+    for (thread& t : threads) t.join();
+    ok = ok && cache.size() <= 256;
+    cout << "Concurrent access (4 threads, 1000 keys, capacity 256) " << (ok ? "Passed" : "Failed") << endl;
+}
+
+// 50000个租户密钥，访问频率服从Zipf分布，每条消息64字节：比较每次建立上下文与使用缓存
+void test_cache_performance() {
+    cout << "=== Multi-Tenant Throughput Test ===\n";
+    const uint32_t tenants = 50000;
+    const int messages = 200000;
+    vector<double> cdf(tenants);
+    double sum = 0;
+    for (uint32_t i = 0; i < tenants; ++i) {
+        sum += 1.0 / pow(i + 1, 1.1);
+        cdf[i] = sum;
+    }
+    mt19937 rng(7);
+    uniform_real_distribution<double> dist(0, sum);
+    vector<uint32_t> trace(messages);
+    for (uint32_t& t : trace) t = static_cast<uint32_t>(lower_bound(cdf.begin(), cdf.end(), dist(rng)) - cdf.begin());
+
+    uint8_t key[16], iv[12] = { 0 }, tag[16];
+    vector<uint8_t> msg(64, 0x5a), ct(64);
+
+    auto start = chrono::high_resolution_clock::now();
+    for (uint32_t t : trace) {
+        tenant_key(t, key);
+        sm4_gcm_encrypt(key, iv, msg.data(), msg.size(), nullptr, 0, ct.data(), tag);
+    }
+    double uncached = chrono::duration<double>(chrono::high_resolution_clock::now() - start).count();
+
+    SM4KeyCache cache(tenants);
+    start = chrono::high_resolution_clock::now();
+    for (uint32_t t : trace) {
+        tenant_key(t, key);
+        sm4_gcm_encrypt(*cache.get(key), iv, msg.data(), msg.size(), nullptr, 0, ct.data(), tag);
+    }
+    double cached = chrono::duration<double>(chrono::high_resolution_clock::now() - start).count();
+
+    cout << "Per-message key setup: " << messages / uncached << " msg/s\n"
+         << "Key context cache:     " << messages / cached << " msg/s (hit rate "
+         << 100.0 * cache.hits() / (cache.hits() + cache.misses()) << "%, " << cache.size() << " contexts)\n";
+}
+
+int main() {
+    test_cache_correctness();
+    test_cache_concurrency();
+    test_cache_performance();
+    return 0;
+}
@@ -0,0 +1,162 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <unordered_map>
+#include <vector>
+#include "SM4-GCM.h"
+#include "SM4-Arena.h"
+
+// 多租户场景下的SM4-GCM密钥上下文缓存
+// 每个上下文包含轮密钥、H和GHASH查表，建立一次要做一次密钥扩展、一次分组加密和建表，
+// 与加密一条短消息的开销相当；热点租户反复出现时直接复用。
+// fold_powers为true时同时预计算H^GCM_FOLD_BLOCKS（十几次逐位GF(2^128)乘法），供并行GCM合并分段使用。
+// 按带随机种子的64位密钥指纹分片（每片一把锁、一条LRU链），命中后再比较完整密钥；
+// 超出容量时淘汰最久未用的上下文，最后一个引用释放时清零归还SecureArena
+class SM4KeyCache {
+public:
+    using Context = std::shared_ptr<const GcmKey>;
+
+    static constexpr size_t DEFAULT_CAPACITY = 65536;
+
+    explicit SM4KeyCache(size_t capacity = DEFAULT_CAPACITY, size_t shards = 16, bool fold_powers = false)
+        : fold_powers_(fold_powers) {
+        if (shards == 0) shards = 1;
+        if (capacity < shards) capacity = shards;
+        std::random_device rd;
+        seed_[0] = (static_cast<uint64_t>(rd()) << 32) | rd();
+        seed_[1] = (static_cast<uint64_t>(rd()) << 32) | rd();
+        for (size_t i = 0; i < shards; ++i) {
+            shards_.push_back(std::make_unique<Shard>());
+            shards_.back()->capacity = capacity / shards + (i < capacity % shards ? 1 : 0);
+        }
+    }
+
+    ~SM4KeyCache() {
+        clear();
+    }
+
+    SM4KeyCache(const SM4KeyCache&) = delete;
+    SM4KeyCache& operator=(const SM4KeyCache&) = delete;
+
+    // 取密钥对应的上下文，不存在时建立并放入缓存；返回的引用在淘汰后仍然有效
+    Context get(const uint8_t key[16]) {
+        uint64_t fp = fingerprint(key);
+        Shard& shard = *shards_[(fp >> 32) % shards_.size()];
+        {
+            std::lock_guard<std::mutex> lock(shard.mutex);
+            auto it = shard.index.find(fp);
+            if (it != shard.index.end() && memcmp(it->second->key, key, 16) == 0) {
+                shard.lru.splice(shard.lru.begin(), shard.lru, it->second);
+                hits_.fetch_add(1, std::memory_order_relaxed);
+                return it->second->context;
+            }
+        }
+        misses_.fetch_add(1, std::memory_order_relaxed);
+
+        // 在锁外建立上下文，不阻塞同一分片上的其他租户
+        Context context = make_context(key);
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        auto it = shard.index.find(fp);
+        if (it != shard.index.end()) {
+            if (memcmp(it->second->key, key, 16) == 0) {
+                // 另一个线程先建好了，用已缓存的那个
+                shard.lru.splice(shard.lru.begin(), shard.lru, it->second);
+                return it->second->context;
+            }
+            erase(shard, it->second);   // 指纹碰撞：新密钥替换旧条目
+        }
+        shard.lru.emplace_front();
+        Entry& entry = shard.lru.front();
+        memcpy(entry.key, key, 16);
+        entry.fingerprint = fp;
+        entry.context = context;
+        shard.index[fp] = shard.lru.begin();
+        while (shard.lru.size() > shard.capacity) {
+            erase(shard, std::prev(shard.lru.end()));
+            evictions_.fetch_add(1, std::memory_order_relaxed);
+        }
+        return context;
+    }
+
+    void clear() {
+        for (auto& shard : shards_) {
+            std::lock_guard<std::mutex> lock(shard->mutex);
+            while (!shard->lru.empty()) erase(*shard, shard->lru.begin());
+        }
+    }
+
+    size_t size() const {
+        size_t n = 0;
+        for (auto& shard : shards_) {
+            std::lock_guard<std::mutex> lock(shard->mutex);
+            n += shard->lru.size();
+        }
+        return n;
+    }
+
+    uint64_t hits() const { return hits_.load(); }
+    uint64_t misses() const { return misses_.load(); }
+    uint64_t evictions() const { return evictions_.load(); }
+
+    // 进程内共享的缓存，容量DEFAULT_CAPACITY。上下文取自SecureArena的512字节大小类，
+    // 装满时约需32MB锁定内存，常见的RLIMIT_MEMLOCK默认值（8MB甚至64KB）远小于此：
+    // 超出部分照常可用但不锁定，SecureArena第一次mlock失败时在stderr提示一次，stats().unlocked_bytes给出总量。
+    // 需要全部锁定时调高RLIMIT_MEMLOCK（ulimit -l），或自建容量更小的SM4KeyCache
+    static SM4KeyCache& global() {
+        static SM4KeyCache cache;
+        return cache;
+    }
+
+private:
+    struct Entry {
+        uint8_t key[16];
+        uint64_t fingerprint;
+        Context context;
+    };
+
+    struct Shard {
+        mutable std::mutex mutex;
+        std::list<Entry> lru;   // 头部最近使用
+        std::unordered_map<uint64_t, std::list<Entry>::iterator> index;
+        size_t capacity = 0;
+    };
+
+    std::vector<std::unique_ptr<Shard>> shards_;
+    uint64_t seed_[2];
+    bool fold_powers_;
+    std::atomic<uint64_t> hits_{0}, misses_{0}, evictions_{0};
+
+    // 带种子的指纹：不同进程/实例间不可预测，外部无法构造大量碰撞挤占同一条目
+    uint64_t fingerprint(const uint8_t key[16]) const {
+        uint64_t a, b;
+        memcpy(&a, key, 8);
+        memcpy(&b, key + 8, 8);
+        uint64_t h = (a ^ seed_[0]) * 0x9e3779b97f4a7c15ULL;
+        h ^= (b ^ seed_[1]) + (h << 6) + (h >> 2);
+        h ^= h >> 33;
+        h *= 0xff51afd7ed558ccdULL;
+        h ^= h >> 33;
+        h *= 0xc4ceb9fe1a85ec53ULL;
+        return h ^ (h >> 33);
+    }
+
+    Context make_context(const uint8_t key[16]) const {
+        secure_unique_ptr<GcmKey> context = make_secure<GcmKey>();
+        gcm_key_init(*context, key, fold_powers_);
+        return Context(std::move(context));
+    }
+
+    static void erase(Shard& shard, std::list<Entry>::iterator it) {
+        shard.index.erase(it->fingerprint);
+        volatile uint8_t* p = it->key;
+        for (int i = 0; i < 16; ++i) p[i] = 0;
+        shard.lru.erase(it);   // 上下文随最后一个引用清零
+    }
+};
@@ -0,0 +1,602 @@
+#include <iostream>
+#include <string>
+#include <vector>
+#include <map>
+#include <memory>
+#include <array>
+#include <thread>
+#include <atomic>
+#include <chrono>
+#include <random>
+#include <csignal>
+#include <cerrno>
+#include <fcntl.h>
+#include <poll.h>
+#include "SM4-Core.h"
+#include "SM4-Offload.h"
+#include "../project4/SM3Hash.h"
+using namespace std;
+using namespace SM4_Offload;
+
+// SM4/SM3卸载服务：许多本地进程各自只提交几个分组，凑不满向量内核
+// 服务端每轮把所有连接上已到达的请求收齐，按方向把分组（可来自不同密钥）每8个一组送进多密钥内核，
+// 密钥按内容在进程间共享同一份轮密钥上下文
+// 单线程服务不能被一个客户端拖住：应答先进连接自己的发送队列，可写时再发；
+// 输入或待发送的应答积压超过上限时暂停读取该连接，直到对方把应答读走
+
+// 扩展后的密钥上下文，多个连接登记同一密钥时共享。
+// 最后一个句柄释放时由OffloadServer的删除器把它移出密钥表，析构时清除密钥和轮密钥
+struct KeyContext {
+    array<uint8_t, 16> key;
+    uint32_t rk[32];
+
+    ~KeyContext() {
+        volatile uint8_t* k = key.data();
+        for (size_t i = 0; i < key.size(); ++i) k[i] = 0;
+        volatile uint32_t* p = rk;
+        for (int i = 0; i < 32; ++i) p[i] = 0;
+    }
+};
+
+class OffloadServer {
+public:
+    explicit OffloadServer(const string& path) : path_(path) {}
+
+    ~OffloadServer() {
+        for (Connection& conn : connections_) ::close(conn.fd);
+        connections_.clear();   // 句柄的删除器要访问key_table_，必须在它析构之前释放
+        if (listen_fd_ >= 0) {
+            ::close(listen_fd_);
+            ::unlink(path_.c_str());
+        }
+    }
+
+    bool listen() {
+        sockaddr_un addr;
+        memset(&addr, 0, sizeof(addr));
+        if (path_.size() >= sizeof(addr.sun_path)) return false;
+        addr.sun_family = AF_UNIX;
+        memcpy(addr.sun_path, path_.c_str(), path_.size());
+        ::unlink(path_.c_str());
+        listen_fd_ = ::socket(AF_UNIX, SOCK_STREAM, 0);
+        if (listen_fd_ < 0 || ::bind(listen_fd_, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) < 0 ||
+            ::listen(listen_fd_, 128) < 0) {
+            return false;
+        }
+        return set_nonblocking(listen_fd_);
+    }
+
+    void stop() {
+        stop_ = true;
+    }
+
+    // 统计：内核调用次数与其中有效分组数
+    uint64_t kernel_calls() const { return kernel_calls_; }
+    uint64_t kernel_blocks() const { return kernel_blocks_; }
+    // 仍被某个连接引用的密钥上下文数
+    size_t live_keys() const { return live_keys_; }
+
+    void run() {
+        vector<pollfd> fds;
+        while (!stop_) {
+            fds.clear();
+            fds.push_back({ listen_fd_, POLLIN, 0 });
+            for (Connection& conn : connections_) {
+                short events = 0;
+                if (wants_input(conn)) events |= POLLIN;
+                if (conn.out_sent < conn.out.size()) events |= POLLOUT;
+                fds.push_back({ conn.fd, events, 0 });
+            }
+            if (::poll(fds.data(), fds.size(), 100) <= 0) continue;
+
+            if (fds[0].revents & POLLIN) accept_clients();
+            for (size_t i = 1; i < fds.size(); ++i) {
+                Connection& conn = connections_[i - 1];
+                if (fds[i].revents & (POLLOUT | POLLHUP | POLLERR)) send_pending(conn);
+                if (wants_input(conn) && (fds[i].revents & (POLLIN | POLLHUP | POLLERR))) receive(conn);
+            }
+            process_batch();
+            flush_and_reap();
+        }
+    }
+
+private:
+    // 输入积压上限：正好容纳一个最大请求，保证任何合法请求都能收齐
+    static constexpr size_t MAX_INPUT_BACKLOG = sizeof(OffloadRequest) + MAX_PAYLOAD;
+    // 待发送应答超过此值就不再读取该连接的新请求
+    static constexpr size_t MAX_OUTPUT_BACKLOG = 2 * MAX_INPUT_BACKLOG;
+
+    struct Connection {
+        int fd;
+        vector<uint8_t> in;     // 已收到的字节，请求在其中原地加解密
+        size_t parsed = 0;      // in中已解析的请求末尾
+        vector<uint8_t> out;    // 待发送的应答
+        size_t out_sent = 0;    // out中已发送的字节
+        vector<shared_ptr<KeyContext>> keys;
+        bool eof = false;       // 对方已不再发送，应答发完后关闭
+        bool closed = false;    // 出错或违反协议，立即关闭
+    };
+
+    struct Job {
+        Connection* conn;
+        OffloadRequest request;
+        size_t offset;                    // payload在conn->in中的位置
+        uint32_t status = STATUS_OK;
+        vector<uint8_t> result;           // 不能原地输出的应答（密钥句柄、摘要）
+        vector<uint8_t> keystream;        // CTR的计数器/密钥流
+    };
+
+    // 批中的一个分组：in/out指向请求缓冲区或密钥流
+    struct BlockUnit {
+        uint8_t* data;
+        const uint32_t* rk;
+    };
+
+    string path_;
+    int listen_fd_ = -1;
+    atomic<bool> stop_{false};
+    vector<Connection> connections_;
+    vector<Job> jobs_;
+    map<array<uint8_t, 16>, weak_ptr<KeyContext>> key_table_;   // 只含仍被引用的上下文
+    atomic<size_t> live_keys_{0};
+    uint64_t kernel_calls_ = 0, kernel_blocks_ = 0;
+
+    static bool set_nonblocking(int fd) {
+        int flags = fcntl(fd, F_GETFL, 0);
+        return flags >= 0 && fcntl(fd, F_SETFL, flags | O_NONBLOCK) == 0;
+    }
+
+    void accept_clients() {
+        int fd;
+        while ((fd = ::accept(listen_fd_, nullptr, nullptr)) >= 0) {
+            set_nonblocking(fd);
+            Connection conn;
+            conn.fd = fd;
+            connections_.push_back(move(conn));
+        }
+    }
+
+    // 输入和输出积压都未超限时才继续读取
+    static bool wants_input(const Connection& conn) {
+        return !conn.eof && !conn.closed && conn.in.size() < MAX_INPUT_BACKLOG &&
+               conn.out.size() - conn.out_sent < MAX_OUTPUT_BACKLOG;
+    }
+
+    // 读出已到达的字节，最多读到输入积压上限
+    void receive(Connection& conn) {
+        uint8_t buffer[64 * 1024];
+        while (conn.in.size() < MAX_INPUT_BACKLOG) {
+            size_t room = min(sizeof(buffer), MAX_INPUT_BACKLOG - conn.in.size());
+            ssize_t n = ::read(conn.fd, buffer, room);
+            if (n > 0) {
+                conn.in.insert(conn.in.end(), buffer, buffer + n);
+                continue;
+            }
+            if (n < 0 && errno == EINTR) continue;
+            if (n == 0) conn.eof = true;
+            else if (errno != EAGAIN) conn.closed = true;
+            break;
+        }
+    }
+
+    void collect_jobs() {
+        jobs_.clear();
+        for (Connection& conn : connections_) {
+            while (conn.in.size() - conn.parsed >= sizeof(OffloadRequest)) {
+                OffloadRequest request;
+                memcpy(&request, conn.in.data() + conn.parsed, sizeof(request));
+                if (request.magic != MAGIC || request.length > MAX_PAYLOAD) {
+                    conn.closed = true;
+                    break;
+                }
+                size_t end = conn.parsed + sizeof(request) + request.length;
+                if (conn.in.size() < end) break;
+                Job job;
+                job.conn = &conn;
+                job.request = request;
+                job.offset = conn.parsed + sizeof(request);
+                jobs_.push_back(move(job));
+                conn.parsed = end;
+            }
+        }
+    }
+
+    const uint32_t* lookup_key(Job& job) {
+        if (job.request.key_handle >= job.conn->keys.size()) {
+            job.status = STATUS_BAD_KEY;
+            return nullptr;
+        }
+        return job.conn->keys[job.request.key_handle]->rk;
+    }
+
+    void open_key(Job& job, const uint8_t* payload) {
+        if (job.request.length != 16) {
+            job.status = STATUS_BAD_REQUEST;
+            return;
+        }
+        if (job.conn->keys.size() >= MAX_KEYS_PER_CONNECTION) {
+            job.status = STATUS_TOO_MANY_KEYS;
+            return;
+        }
+        array<uint8_t, 16> key;
+        memcpy(key.data(), payload, 16);
+        shared_ptr<KeyContext> context;
+        auto it = key_table_.find(key);
+        if (it != key_table_.end()) context = it->second.lock();
+        if (!context) {
+            // 服务是单线程的，删除器在连接关闭时于同一线程内运行，可以直接改密钥表
+            context.reset(new KeyContext, [this](KeyContext* c) {
+                key_table_.erase(c->key);
+                --live_keys_;
+                delete c;
+            });
+            context->key = key;
+            SM4_Core::expand_key(key.data(), context->rk);
+            key_table_[key] = context;
+            ++live_keys_;
+        }
+        volatile uint8_t* k = key.data();
+        for (size_t i = 0; i < key.size(); ++i) k[i] = 0;
+        uint32_t handle = static_cast<uint32_t>(job.conn->keys.size());
+        job.conn->keys.push_back(context);
+        job.result.resize(4);
+        memcpy(job.result.data(), &handle, 4);
+    }
+
+    // 每8个分组一次多密钥内核，不足8个时用第一个分组补齐
+    void run_units(const vector<BlockUnit>& units, bool encrypt) {
+        alignas(32) uint8_t batch[8 * 16];
+        const uint32_t* keys[8];
+        for (size_t i = 0; i < units.size(); i += 8) {
+            size_t n = min<size_t>(8, units.size() - i);
+            for (size_t b = 0; b < 8; ++b) {
+                const BlockUnit& unit = units[i + (b < n ? b : 0)];
+                memcpy(batch + b * 16, unit.data, 16);
+                keys[b] = unit.rk;
+            }
+            SM4_Core::crypt_blocks8_multikey(batch, batch, keys, encrypt);
+            for (size_t b = 0; b < n; ++b) {
+                memcpy(units[i + b].data, batch + b * 16, 16);
+            }
+            ++kernel_calls_;
+            kernel_blocks_ += n;
+        }
+    }
+
+    void process_batch() {
+        collect_jobs();
+        vector<BlockUnit> encrypt_units, decrypt_units;
+        SM3Hash sm3;
+
+        for (Job& job : jobs_) {
+            uint8_t* payload = job.conn->in.data() + job.offset;
+            size_t len = job.request.length;
+            switch (job.request.op) {
+            case OP_OPEN_KEY:
+                open_key(job, payload);
+                break;
+            case OP_ECB_ENCRYPT:
+            case OP_ECB_DECRYPT: {
+                const uint32_t* rk = lookup_key(job);
+                if (!rk) break;
+                if (len % 16) {
+                    job.status = STATUS_BAD_REQUEST;
+                    break;
+                }
+                auto& units = job.request.op == OP_ECB_ENCRYPT ? encrypt_units : decrypt_units;
+                for (size_t off = 0; off < len; off += 16) units.push_back({ payload + off, rk });
+                break;
+            }
+            case OP_CTR: {
+                const uint32_t* rk = lookup_key(job);
+                if (!rk) break;
+                size_t blocks = (len + 15) / 16;
+                job.keystream.resize(blocks * 16);
+                uint8_t counter[16];
+                memcpy(counter, job.request.iv, 16);
+                for (size_t b = 0; b < blocks; ++b) {
+                    memcpy(job.keystream.data() + b * 16, counter, 16);
+                    SM4_Core::counter128_add(counter, 1);
+                    encrypt_units.push_back({ job.keystream.data() + b * 16, rk });
+                }
+                break;
+            }
+            case OP_SM3: {
+                job.result = sm3.compute(payload, len);
+                break;
+            }
+            default:
+                job.status = STATUS_BAD_REQUEST;
+            }
+        }
+
+        run_units(encrypt_units, true);
+        run_units(decrypt_units, false);
+
+        for (Job& job : jobs_) {
+            if (job.request.op == OP_CTR && job.status == STATUS_OK) {
+                uint8_t* payload = job.conn->in.data() + job.offset;
+                for (size_t i = 0; i < job.request.length; ++i) payload[i] ^= job.keystream[i];
+            }
+        }
+    }
+
+    // 按请求顺序把应答放进各连接的发送队列并尽量发出，然后丢弃已处理的输入，关闭断开的连接
+    void flush_and_reap() {
+        for (Job& job : jobs_) {
+            Connection& conn = *job.conn;
+            OffloadResponse response;
+            response.status = job.status;
+            const uint8_t* payload = nullptr;
+            if (job.status != STATUS_OK) {
+                response.length = 0;
+            } else if (job.request.op == OP_OPEN_KEY || job.request.op == OP_SM3) {
+                response.length = static_cast<uint32_t>(job.result.size());
+                payload = job.result.data();
+            } else {
+                response.length = job.request.length;
+                payload = conn.in.data() + job.offset;
+            }
+            const uint8_t* header = reinterpret_cast<const uint8_t*>(&response);
+            conn.out.insert(conn.out.end(), header, header + sizeof(response));
+            if (response.length > 0) conn.out.insert(conn.out.end(), payload, payload + response.length);
+        }
+        jobs_.clear();
+
+        for (Connection& conn : connections_) {
+            conn.in.erase(conn.in.begin(), conn.in.begin() + static_cast<ptrdiff_t>(conn.parsed));
+            conn.parsed = 0;
+            send_pending(conn);
+        }
+        for (size_t i = 0; i < connections_.size();) {
+            const Connection& conn = connections_[i];
+            if (conn.closed || (conn.eof && conn.out_sent == conn.out.size())) {
+                ::close(connections_[i].fd);
+                connections_.erase(connections_.begin() + static_cast<ptrdiff_t>(i));
+            } else {
+                ++i;
+            }
+        }
+    }
+
+    // 发送队列中的应答，发送缓冲区满时留到下次POLLOUT
+    static void send_pending(Connection& conn) {
+        while (!conn.closed && conn.out_sent < conn.out.size()) {
+            ssize_t n = ::send(conn.fd, conn.out.data() + conn.out_sent, conn.out.size() - conn.out_sent, MSG_NOSIGNAL);
+            if (n > 0) {
+                conn.out_sent += static_cast<size_t>(n);
+            } else if (n < 0 && errno == EINTR) {
+                continue;
+            } else if (n < 0 && errno == EAGAIN) {
+                break;
+            } else {
+                conn.closed = true;
+            }
+        }
+        if (conn.out_sent == conn.out.size()) {
+            conn.out.clear();
+            conn.out_sent = 0;
+        } else if (conn.out_sent >= MAX_INPUT_BACKLOG) {
+            conn.out.erase(conn.out.begin(), conn.out.begin() + static_cast<ptrdiff_t>(conn.out_sent));
+            conn.out_sent = 0;
+        }
+    }
+};
+
+// --- 自测：多个客户端线程并发提交小请求，与本地计算结果比较 ---
+bool client_worker(const string& path, int id, int requests, atomic<uint64_t>& bytes) {
+    OffloadClient client;
+    if (!client.connect(path)) return false;
+    mt19937 rng(id);
+    uint8_t key[16];
+    for (uint8_t& b : key) b = static_cast<uint8_t>(rng());
+    uint32_t handle;
+    if (!client.open_key(key, handle)) return false;
+    uint32_t rk[32];
+    SM4_Core::expand_key(key, rk);
+    SM3Hash sm3;
+
+    for (int r = 0; r < requests; ++r) {
+        size_t blocks = 1 + rng() % 4;
+        vector<uint8_t> data(blocks * 16), out(blocks * 16), expected(blocks * 16), back(blocks * 16);
+        for (uint8_t& b : data) b = static_cast<uint8_t>(rng());
+
+        switch (r % 3) {
+        case 0:
+            SM4_Core::crypt_blocks(data.data(), expected.data(), blocks, rk);
+            if (!client.ecb(handle, true, data.data(), out.data(), data.size()) || out != expected) return false;
+            if (!client.ecb(handle, false, out.data(), back.data(), out.size()) || back != data) return false;
+            break;
+        case 1: {
+            uint8_t counter[16], ks[16];
+            for (uint8_t& b : counter) b = static_cast<uint8_t>(rng());
+            size_t len = data.size() - rng() % 16;
+            if (!client.ctr(handle, counter, data.data(), out.data(), len)) return false;
+            for (size_t i = 0; i < len; ++i) {
+                if (i % 16 == 0) {
+                    SM4_Core::crypt_block(counter, ks, rk);
+                    SM4_Core::counter128_add(counter, 1);
+                }
+                if (out[i] != (data[i] ^ ks[i % 16])) return false;
+            }
+            break;
+        }
+        default: {
+            uint8_t digest[32];
+            if (!client.sm3(data.data(), data.size(), digest)) return false;
+            vector<uint8_t> local = sm3.compute(data.data(), data.size());
+            if (memcmp(digest, local.data(), 32) != 0) return false;
+        }
+        }
+        bytes += data.size();
+    }
+    return true;
+}
+
+// 不读应答的客户端：非阻塞地连续发送64KB的ECB请求，直到服务端停止读取、发送缓冲区写满。返回完整发出的请求数
+int flood_without_reading(int fd, uint32_t handle) {
+    constexpr size_t PAYLOAD = 64 * 1024;
+    vector<uint8_t> request(sizeof(OffloadRequest) + PAYLOAD, 0x33);
+    OffloadRequest header;
+    memset(&header, 0, sizeof(header));
+    header.magic = MAGIC;
+    header.op = OP_ECB_ENCRYPT;
+    header.key_handle = handle;
+    header.length = PAYLOAD;
+    memcpy(request.data(), &header, sizeof(header));
+
+    int fl = fcntl(fd, F_GETFL, 0);
+    fcntl(fd, F_SETFL, fl | O_NONBLOCK);
+    int complete = 0;
+    size_t pos = 0;
+    for (;;) {
+        ssize_t n = ::send(fd, request.data() + pos, request.size() - pos, MSG_NOSIGNAL);
+        if (n > 0) {
+            pos += static_cast<size_t>(n);
+            if (pos == request.size()) {
+                ++complete;
+                pos = 0;
+            }
+            continue;
+        }
+        if (n < 0 && errno == EAGAIN) {
+            pollfd pfd = { fd, POLLOUT, 0 };
+            if (::poll(&pfd, 1, 300) == 0) break;   // 服务端已不再读取
+            continue;
+        }
+        return -1;
+    }
+    fcntl(fd, F_SETFL, fl);
+    return complete;
+}
+
+// 一个客户端灌满请求且不读应答时，其他客户端不受影响；之后它仍能按顺序收到每个完整请求的应答
+bool test_stalled_client(const string& path, int clients, int requests) {
+    OffloadClient keys;
+    if (!keys.connect(path)) return false;
+    uint8_t key[16] = { 0 };
+    uint32_t handle = 0;
+    for (uint32_t i = 0; i < MAX_KEYS_PER_CONNECTION; ++i) {
+        if (!keys.open_key(key, handle)) return false;
+    }
+    if (keys.open_key(key, handle)) return false;   // 超过句柄上限
+
+    int fd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+    sockaddr_un addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    memcpy(addr.sun_path, path.c_str(), path.size());
+    if (fd < 0 || ::connect(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0) return false;
+    OffloadRequest open;
+    memset(&open, 0, sizeof(open));
+    open.magic = MAGIC;
+    open.op = OP_OPEN_KEY;
+    open.length = 16;
+    OffloadResponse response;
+    if (!write_all(fd, &open, sizeof(open)) || !write_all(fd, key, 16) ||
+        !read_all(fd, &response, sizeof(response)) || response.status != STATUS_OK ||
+        !read_all(fd, &handle, 4)) {
+        ::close(fd);
+        return false;
+    }
+    int flooded = flood_without_reading(fd, handle);
+
+    atomic<uint64_t> bytes{0};
+    vector<thread> workers;
+    vector<char> ok(clients, 0);
+    for (int i = 0; i < clients; ++i) {
+        workers.emplace_back([&, i] { ok[i] = client_worker(path, 100 + i, requests, bytes); });
+    }
+    for (thread& t : workers) t.join();
+    bool passed = flooded > 0;
+    for (char c : ok) passed = passed && c;
+
+    // 补读积压的应答
+    vector<uint8_t> payload;
+    for (int i = 0; passed && i < flooded; ++i) {
+        passed = read_all(fd, &response, sizeof(response)) && response.status == STATUS_OK;
+        payload.resize(response.length);
+        passed = passed && read_all(fd, payload.data(), payload.size());
+    }
+    ::close(fd);
+    return passed;
+}
+
+void run_selftest(int clients, int requests) {
+    cout << "=== SM4/SM3 Offload Service Self-Test ===\n";
+    string path = "/tmp/sm4-offload-" + to_string(getpid()) + ".sock";
+    OffloadServer server(path);
+    if (!server.listen()) {
+        cout << "cannot listen on " << path << endl;
+        return;
+    }
+    thread service(&OffloadServer::run, &server);
+
+    atomic<uint64_t> bytes{0};
+    vector<thread> workers;
+    vector<char> ok(clients, 0);
+    auto start = chrono::high_resolution_clock::now();
+    for (int i = 0; i < clients; ++i) {
+        workers.emplace_back([&, i] { ok[i] = client_worker(path, i + 1, requests, bytes); });
+    }
+    for (thread& t : workers) t.join();
+    auto end = chrono::high_resolution_clock::now();
+    server.stop();
+    service.join();
+
+    bool all_ok = true;
+    for (char c : ok) all_ok = all_ok && c;
+    double seconds = chrono::duration<double>(end - start).count();
+    cout << clients << " clients x " << requests << " requests: " << (all_ok ? "Passed" : "Failed") << "\n"
+         << "Requests/s: " << clients * requests / seconds << "\n"
+         << "Average blocks per 8-lane kernel call: "
+         << (server.kernel_calls() ? static_cast<double>(server.kernel_blocks()) / server.kernel_calls() : 0.0) << endl;
+}
+
+void run_stall_test() {
+    cout << "=== Offload Service Backpressure Test ===\n";
+    string path = "/tmp/sm4-offload-stall-" + to_string(getpid()) + ".sock";
+    OffloadServer server(path);
+    if (!server.listen()) {
+        cout << "cannot listen on " << path << endl;
+        return;
+    }
+    thread service(&OffloadServer::run, &server);
+    bool ok = test_stalled_client(path, 4, 200);
+    // 所有客户端都已断开，服务端回收连接后密钥表应为空
+    for (int i = 0; i < 200 && server.live_keys() > 0; ++i) this_thread::sleep_for(chrono::milliseconds(10));
+    bool released = server.live_keys() == 0;
+    server.stop();
+    service.join();
+    cout << "Stalled client and key handle limit: " << (ok ? "Passed" : "Failed") << "\n"
+         << "Key contexts released after disconnect: " << (released ? "Passed" : "Failed") << endl;
+}
+
+OffloadServer* g_server = nullptr;
+
+void handle_signal(int) {
+    if (g_server) g_server->stop();
+}
+
+int main(int argc, char* argv[]) {
+    if (argc >= 3 && string(argv[1]) == "serve") {
+        OffloadServer server(argv[2]);
+        if (!server.listen()) {
+            cerr << "sm4_offload: cannot listen on " << argv[2] << endl;
+            return 1;
+        }
+        g_server = &server;
+        signal(SIGINT, handle_signal);
+        signal(SIGTERM, handle_signal);
+        server.run();
+        return 0;
+    }
+    if (argc >= 2 && string(argv[1]) != "selftest") {
+        cerr << "usage: sm4_offload serve <socket-path>\n"
+                "       sm4_offload [selftest]\n";
+        return 2;
+    }
+    run_selftest(16, 600);
+    run_stall_test();
+    return 0;
+}
@@ -0,0 +1,133 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+// SM4/SM3卸载服务的协议与客户端（Unix域套接字）
+// 每个请求为 OffloadRequest + payload，每个应答为 OffloadResponse + payload，整数按本机字节序
+namespace SM4_Offload {
+
+constexpr uint32_t MAGIC = 0x534d344f;              // "SM4O"
+constexpr uint32_t MAX_PAYLOAD = 1 << 20;
+constexpr uint32_t MAX_KEYS_PER_CONNECTION = 1024;  // 每个连接最多登记的密钥句柄数
+
+enum Op : uint16_t {
+    OP_OPEN_KEY = 1,      // payload为16字节密钥，应答payload为4字节密钥句柄
+    OP_ECB_ENCRYPT = 2,   // payload为整数个分组
+    OP_ECB_DECRYPT = 3,
+    OP_CTR = 4,           // iv为初始计数器（128位递增），payload任意长度
+    OP_SM3 = 5,           // 应答payload为32字节摘要
+};
+
+enum Status : uint32_t {
+    STATUS_OK = 0,
+    STATUS_BAD_REQUEST = 1,
+    STATUS_BAD_KEY = 2,
+    STATUS_TOO_MANY_KEYS = 3,   // 连接上的密钥句柄已达MAX_KEYS_PER_CONNECTION
+};
+
+struct OffloadRequest {
+    uint32_t magic;
+    uint16_t op;
+    uint16_t reserved;
+    uint32_t key_handle;
+    uint32_t length;
+    uint8_t iv[16];
+};
+
+struct OffloadResponse {
+    uint32_t status;
+    uint32_t length;
+};
+
+inline bool write_all(int fd, const void* data, size_t len) {
+    const uint8_t* p = static_cast<const uint8_t*>(data);
+    while (len > 0) {
+        ssize_t n = ::send(fd, p, len, MSG_NOSIGNAL);
+        if (n <= 0) return false;
+        p += n;
+        len -= static_cast<size_t>(n);
+    }
+    return true;
+}
+
+inline bool read_all(int fd, void* data, size_t len) {
+    uint8_t* p = static_cast<uint8_t*>(data);
+    while (len > 0) {
+        ssize_t n = ::read(fd, p, len);
+        if (n <= 0) return false;
+        p += n;
+        len -= static_cast<size_t>(n);
+    }
+    return true;
+}
+
+// 同步客户端：一个连接上请求依次发送，由服务端与其他进程的请求合批处理
+class OffloadClient {
+public:
+    OffloadClient() = default;
+    OffloadClient(const OffloadClient&) = delete;
+    OffloadClient& operator=(const OffloadClient&) = delete;
+
+    ~OffloadClient() {
+        if (fd_ >= 0) ::close(fd_);
+    }
+
+    bool connect(const std::string& path) {
+        sockaddr_un addr;
+        memset(&addr, 0, sizeof(addr));
+        if (path.size() >= sizeof(addr.sun_path)) return false;
+        addr.sun_family = AF_UNIX;
+        memcpy(addr.sun_path, path.c_str(), path.size());
+        fd_ = ::socket(AF_UNIX, SOCK_STREAM, 0);
+        return fd_ >= 0 && ::connect(fd_, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) == 0;
+    }
+
+    // 在服务端登记密钥，之后的请求只携带句柄
+    bool open_key(const uint8_t key[16], uint32_t& handle) {
+        uint8_t reply[4];
+        if (!call(OP_OPEN_KEY, 0, nullptr, key, 16, reply, 4)) return false;
+        memcpy(&handle, reply, 4);
+        return true;
+    }
+
+    bool ecb(uint32_t handle, bool encrypt, const uint8_t* in, uint8_t* out, size_t len) {
+        return len % 16 == 0 && call(encrypt ? OP_ECB_ENCRYPT : OP_ECB_DECRYPT, handle, nullptr, in, len, out, len);
+    }
+
+    bool ctr(uint32_t handle, const uint8_t counter[16], const uint8_t* in, uint8_t* out, size_t len) {
+        return call(OP_CTR, handle, counter, in, len, out, len);
+    }
+
+    bool sm3(const uint8_t* data, size_t len, uint8_t digest[32]) {
+        return call(OP_SM3, 0, nullptr, data, len, digest, 32);
+    }
+
+private:
+    int fd_ = -1;
+
+    bool call(Op op, uint32_t handle, const uint8_t iv[16], const uint8_t* payload, size_t len,
+              uint8_t* out, size_t out_len) {
+        if (fd_ < 0 || len > MAX_PAYLOAD) return false;
+        OffloadRequest request;
+        memset(&request, 0, sizeof(request));
+        request.magic = MAGIC;
+        request.op = op;
+        request.key_handle = handle;
+        request.length = static_cast<uint32_t>(len);
+        if (iv) memcpy(request.iv, iv, 16);
+        if (!write_all(fd_, &request, sizeof(request)) || !write_all(fd_, payload, len)) return false;
+
+        OffloadResponse response;
+        if (!read_all(fd_, &response, sizeof(response))) return false;
+        if (response.status != STATUS_OK || response.length != out_len) return false;
+        return read_all(fd_, out, out_len);
+    }
+};
+
+} // namespace SM4_Offload
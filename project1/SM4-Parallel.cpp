@@ -0,0 +1,164 @@
+#include <iostream>
+#include <vector>
+#include <string>
+#include <chrono>
+#include <random>
+#include <cstdio>
+#include "SM4-Parallel.h"
+using namespace std;
+
+// --- 测试 ---
+
+vector<uint8_t> random_bytes(size_t n, uint32_t seed) {
+    mt19937 rng(seed);
+    vector<uint8_t> v(n);
+    for (uint8_t& b : v) b = static_cast<uint8_t>(rng());
+    return v;
+}
+
+bool test_modes(WorkStealingPool& pool, size_t len) {
+    uint8_t key[16], iv[16];
+    for (int i = 0; i < 16; ++i) key[i] = static_cast<uint8_t>(i * 17 + 3);
+    for (int i = 0; i < 16; ++i) iv[i] = static_cast<uint8_t>(0xf0 + i);
+    uint32_t rk[32];
+    SM4_Core::expand_key(key, rk);
+    vector<uint8_t> data = random_bytes(len, static_cast<uint32_t>(len));
+    size_t blocks = len / 16;
+
+    // ECB
+    vector<uint8_t> expected(len), out(len), back(len);
+    SM4_Core::crypt_blocks(data.data(), expected.data(), blocks, rk);
+    sm4_ecb_parallel(pool, rk, data.data(), out.data(), blocks, true);
+    if (memcmp(out.data(), expected.data(), blocks * 16) != 0) return false;
+    sm4_ecb_parallel(pool, rk, out.data(), back.data(), blocks, false);
+    if (memcmp(back.data(), data.data(), blocks * 16) != 0) return false;
+
+    // CBC解密：与顺序加密互逆
+    vector<uint8_t> cbc(blocks * 16);
+    uint8_t prev[16];
+    memcpy(prev, iv, 16);
+    for (size_t b = 0; b < blocks; ++b) {
+        uint8_t x[16];
+        for (int i = 0; i < 16; ++i) x[i] = data[b * 16 + i] ^ prev[i];
+        SM4_Core::crypt_block(x, cbc.data() + b * 16, rk);
+        memcpy(prev, cbc.data() + b * 16, 16);
+    }
+    sm4_cbc_decrypt_parallel(pool, rk, iv, cbc.data(), back.data(), blocks);
+    if (memcmp(back.data(), data.data(), blocks * 16) != 0) return false;
+
+    // CTR：与单段结果一致
+    ctr_crypt_range(rk, iv, true, 0, data.data(), expected.data(), len);
+    sm4_ctr_parallel(pool, rk, iv, data.data(), out.data(), len);
+    if (out != expected) return false;
+
+    // GCM：与sm4_gcm_encrypt一致，原地解密并认证
+    const uint8_t aad[7] = { 1, 2, 3, 4, 5, 6, 7 };
+    uint8_t tag[16], expected_tag[16];
+    sm4_gcm_encrypt(key, iv, data.data(), len, aad, sizeof(aad), expected.data(), expected_tag);
+    sm4_gcm_encrypt_parallel(pool, key, iv, data.data(), len, aad, sizeof(aad), out.data(), tag);
+    if (out != expected || memcmp(tag, expected_tag, 16) != 0) return false;
+    if (!sm4_gcm_decrypt_parallel(pool, key, iv, out.data(), len, aad, sizeof(aad), tag, out.data())) return false;
+    if (out != data) return false;
+    tag[3] ^= 1;
+    return !sm4_gcm_decrypt_parallel(pool, key, iv, expected.data(), len, aad, sizeof(aad), tag, back.data());
+}
+
+// 顺序递归的树哈希参考实现
+vector<uint8_t> tree_reference(const vector<vector<uint8_t>>& nodes) {
+    if (nodes.size() == 1) return nodes[0];
+    SM3Hash sm3;
+    vector<vector<uint8_t>> parent;
+    for (size_t i = 0; i + 1 < nodes.size(); i += 2) {
+        vector<uint8_t> buf(1, 0x01);
+        buf.insert(buf.end(), nodes[i].begin(), nodes[i].end());
+        buf.insert(buf.end(), nodes[i + 1].begin(), nodes[i + 1].end());
+        parent.push_back(sm3.compute(buf.data(), buf.size()));
+    }
+    if (nodes.size() % 2) parent.push_back(nodes.back());
+    return tree_reference(parent);
+}
+
+bool test_tree_hash(WorkStealingPool& pool, size_t len, size_t leaf) {
+    vector<uint8_t> data = random_bytes(len, 99);
+    SM3Hash sm3;
+    vector<vector<uint8_t>> leaves;
+    for (size_t off = 0; off < len || leaves.empty(); off += leaf) {
+        size_t n = min(leaf, len - min(off, len));
+        vector<uint8_t> buf(1, 0x00);
+        buf.insert(buf.end(), data.begin() + off, data.begin() + off + n);
+        leaves.push_back(sm3.compute(buf.data(), buf.size()));
+        if (n == 0) break;
+    }
+    return sm3_tree_hash(pool, data.data(), len, leaf) == tree_reference(leaves);
+}
+
+bool test_hash_files(WorkStealingPool& pool) {
+    vector<string> paths;
+    vector<vector<uint8_t>> contents;
+    SM3Hash sm3;
+    for (int i = 0; i < 20; ++i) {
+        string path = "/tmp/sm4_parallel_test_" + to_string(i) + ".bin";
+        contents.push_back(random_bytes(static_cast<size_t>(i) * 1000 + 1, static_cast<uint32_t>(i)));
+        FILE* f = fopen(path.c_str(), "wb");
+        if (!f) return false;
+        fwrite(contents.back().data(), 1, contents.back().size(), f);
+        fclose(f);
+        paths.push_back(path);
+    }
+    paths.push_back("/tmp/sm4_parallel_test_missing.bin");
+    vector<vector<uint8_t>> digests = sm3_hash_files(pool, paths);
+    bool ok = digests.back().empty();
+    for (size_t i = 0; i < contents.size(); ++i) {
+        ok = ok && digests[i] == sm3.compute(contents[i].data(), contents[i].size());
+        remove(paths[i].c_str());
+    }
+    return ok;
+}
+
+void test_parallel_correctness(WorkStealingPool& pool) {
+    cout << "=== Work-Stealing Parallel Modes Correctness Test ===\n";
+    bool ok = true;
+    for (size_t len : { 0, 1, 15, 16, 100, 65535, 65536, 65552, 1000000 }) {
+        ok = ok && test_modes(pool, len);
+    }
+    cout << "ECB/CBC/CTR/GCM parallel " << (ok ? "Passed" : "Failed") << endl;
+    bool tree = test_tree_hash(pool, 0, 4096) && test_tree_hash(pool, 1, 4096) &&
+                test_tree_hash(pool, 4096 * 7 + 5, 4096) && test_tree_hash(pool, 4096 * 8, 4096);
+    cout << "SM3 tree hash " << (tree ? "Passed" : "Failed") << endl;
+    cout << "SM3 multi-file hash " << (test_hash_files(pool) ? "Passed" : "Failed") << endl;
+}
+
+// 混合负载：一个大对象和几千个小对象同时提交到同一个池
+void test_mixed_workload(WorkStealingPool& pool) {
+    cout << "=== Mixed Workload Test ===\n";
+    vector<uint8_t> big = random_bytes(64 * 1024 * 1024, 1), big_out(big.size());
+    const size_t small_count = 5000;
+    vector<vector<uint8_t>> small(small_count, vector<uint8_t>(256, 0x33)), small_out(small_count, vector<uint8_t>(256));
+    uint8_t key[16] = { 0 }, iv[12] = { 0 }, tag[16];
+
+    uint64_t steals_before = pool.steals();
+    auto start = chrono::high_resolution_clock::now();
+    {
+        TaskGroup group(pool);
+        group.run([&] { sm4_gcm_encrypt_parallel(pool, key, iv, big.data(), big.size(), nullptr, 0, big_out.data(), tag); });
+        for (size_t i = 0; i < small_count; ++i) {
+            group.run([&, i] {
+                uint8_t t[16];
+                sm4_gcm_encrypt(key, iv, small[i].data(), small[i].size(), nullptr, 0, small_out[i].data(), t);
+            });
+        }
+        group.wait();
+    }
+    auto end = chrono::high_resolution_clock::now();
+    double seconds = chrono::duration<double>(end - start).count();
+    cout << pool.size() << " workers: " << seconds * 1000 << " ms, "
+         << (big.size() + small_count * 256) / 1024.0 / 1024.0 / seconds << " MB/s, steals: "
+         << pool.steals() - steals_before << endl;
+}
+
+int main() {
+    WorkStealingPool pool;
+    test_parallel_correctness(pool);
+    test_mixed_workload(pool);
+    return 0;
+}
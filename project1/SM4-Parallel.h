@@ -0,0 +1,225 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <string>
+#include <vector>
+#include "SM4-Core.h"
+#include "SM4-GCM.h"
+#include "WorkStealingPool.h"
+#include "../project4/SM3Hash.h"
+
+// 基于工作窃取线程池的并行SM4工作模式、并行GCM和SM3树哈希/多文件哈希
+// 大任务按PARALLEL_GRAIN_BLOCKS递归拆分，小任务各自成为一个任务，由空闲线程窃取
+
+constexpr size_t PARALLEL_GRAIN_BLOCKS = GCM_FOLD_BLOCKS;   // 64KB，与GcmKey::H_fold对应
+
+// --- ECB ---
+inline void sm4_ecb_parallel(WorkStealingPool& pool, const uint32_t rk[32], const uint8_t* in, uint8_t* out,
+    size_t blocks, bool encrypt) {
+    parallel_for(pool, 0, blocks, PARALLEL_GRAIN_BLOCKS, [&](size_t lo, size_t hi) {
+        SM4_Core::crypt_blocks(in + lo * 16, out + lo * 16, hi - lo, rk, encrypt);
+    });
+}
+
+// --- CBC解密（各分组只依赖前一个密文分组，可以并行）；in与out不能重叠 ---
+inline void sm4_cbc_decrypt_parallel(WorkStealingPool& pool, const uint32_t rk[32], const uint8_t iv[16],
+    const uint8_t* in, uint8_t* out, size_t blocks) {
+    parallel_for(pool, 0, blocks, PARALLEL_GRAIN_BLOCKS, [&](size_t lo, size_t hi) {
+        SM4_Core::crypt_blocks(in + lo * 16, out + lo * 16, hi - lo, rk, false);
+        for (size_t b = lo; b < hi; ++b) {
+            const uint8_t* prev = b == 0 ? iv : in + (b - 1) * 16;
+            for (int i = 0; i < 16; ++i) out[b * 16 + i] ^= prev[i];
+        }
+    });
+}
+
+// --- 计数器模式：分段独立生成密钥流；wide_counter为true时按128位递增（CTR），否则按inc32（GCM） ---
+inline void ctr_crypt_range(const uint32_t rk[32], const uint8_t counter0[16], bool wide_counter,
+    size_t first_block, const uint8_t* in, uint8_t* out, size_t len) {
+    constexpr size_t BATCH_BLOCKS = 64;
+    alignas(64) uint8_t keystream[BATCH_BLOCKS * 16];
+    uint8_t counter[16];
+    memcpy(counter, counter0, 16);
+    if (wide_counter) {
+        SM4_Core::counter128_add(counter, first_block);
+    } else {
+        gcm_counter_add(counter, static_cast<uint32_t>(first_block));
+    }
+    while (len > 0) {
+        size_t blocks = (len + 15) / 16 < BATCH_BLOCKS ? (len + 15) / 16 : BATCH_BLOCKS;
+        for (size_t b = 0; b < blocks; ++b) {
+            memcpy(keystream + b * 16, counter, 16);
+            if (wide_counter) {
+                SM4_Core::counter128_add(counter, 1);
+            } else {
+                gcm_counter_add(counter, 1);
+            }
+        }
+        SM4_Core::crypt_blocks(keystream, keystream, blocks, rk);
+        size_t n = blocks * 16 < len ? blocks * 16 : len;
+        for (size_t i = 0; i < n; ++i) out[i] = in[i] ^ keystream[i];
+        in += n;
+        out += n;
+        len -= n;
+    }
+}
+
+inline void sm4_ctr_parallel(WorkStealingPool& pool, const uint32_t rk[32], const uint8_t counter[16],
+    const uint8_t* in, uint8_t* out, size_t len) {
+    size_t blocks = (len + 15) / 16;
+    parallel_for(pool, 0, blocks, PARALLEL_GRAIN_BLOCKS, [&](size_t lo, size_t hi) {
+        size_t end = hi * 16 < len ? hi * 16 : len;
+        ctr_crypt_range(rk, counter, true, lo, in + lo * 16, out + lo * 16, end - lo * 16);
+    });
+}
+
+// --- 并行GCM：各段加解密并计算自己的GHASH部分和S_i，最后按序合并 Y = Y·H^m_i ^ S_i ---
+// 整段的H^m取自密钥上下文（有H_fold时），只有末尾不足一段时现算
+inline void gcm_parallel_tag(WorkStealingPool& pool, const GcmKey& key, const uint8_t J0[16],
+    const uint8_t* aad, size_t aad_len, const uint8_t* in, uint8_t* out, size_t len, bool encrypt, uint8_t tag[16]) {
+    const size_t chunk_bytes = PARALLEL_GRAIN_BLOCKS * 16;
+    size_t chunks = (len + chunk_bytes - 1) / chunk_bytes;
+    std::vector<std::array<uint8_t, 16>> partial(chunks);
+    uint8_t ctr0[16];
+    memcpy(ctr0, J0, 16);
+    gcm_counter_add(ctr0, 1);
+
+    parallel_for(pool, 0, chunks, 1, [&](size_t lo, size_t hi) {
+        for (size_t c = lo; c < hi; ++c) {
+            size_t offset = c * chunk_bytes;
+            size_t n = len - offset < chunk_bytes ? len - offset : chunk_bytes;
+            GHASH ghash = key.ghash;
+            if (!encrypt) ghash.update_padded(in + offset, n);   // 解密时先对密文求GHASH，允许原地
+            ctr_crypt_range(key.rk, ctr0, false, offset / 16, in + offset, out + offset, n);
+            if (encrypt) ghash.update_padded(out + offset, n);
+            memcpy(partial[c].data(), ghash.Y, 16);
+        }
+    });
+
+    GHASH ghash = key.ghash;
+    ghash.update_padded(aad, aad_len);
+    uint8_t full_power[16], power[16], tmp[16];
+    if (key.has_fold) {
+        memcpy(full_power, key.H_fold, 16);
+    } else if (len >= chunk_bytes) {
+        gf_pow(key.H, PARALLEL_GRAIN_BLOCKS, full_power);
+    }
+    for (size_t c = 0; c < chunks; ++c) {
+        size_t n = len - c * chunk_bytes < chunk_bytes ? len - c * chunk_bytes : chunk_bytes;
+        if (n == chunk_bytes) {
+            memcpy(power, full_power, 16);
+        } else {
+            gf_pow(key.H, (n + 15) / 16, power);
+        }
+        gf_mul(ghash.Y, power, tmp);
+        xor_128(ghash.Y, tmp, partial[c].data());
+    }
+    ghash.finalize(aad_len, len, tag);
+    uint8_t s[16];
+    SM4_Core::crypt_block(J0, s, key.rk);
+    xor_128(tag, tag, s);
+}
+
+inline void sm4_gcm_encrypt_parallel(WorkStealingPool& pool, const GcmKey& key, const uint8_t iv[12],
+    const uint8_t* plaintext, size_t pt_len, const uint8_t* aad, size_t aad_len,
+    uint8_t* ciphertext, uint8_t tag[16]) {
+    uint8_t J0[16];
+    gcm_make_j0(iv, J0);
+    gcm_parallel_tag(pool, key, J0, aad, aad_len, plaintext, ciphertext, pt_len, true, tag);
+}
+
+// 返回true表示认证通过（与sm4_gcm_decrypt一样，明文总会写出）
+inline bool sm4_gcm_decrypt_parallel(WorkStealingPool& pool, const GcmKey& key, const uint8_t iv[12],
+    const uint8_t* ciphertext, size_t ct_len, const uint8_t* aad, size_t aad_len,
+    const uint8_t tag[16], uint8_t* plaintext) {
+    uint8_t J0[16], calc_tag[16];
+    gcm_make_j0(iv, J0);
+    gcm_parallel_tag(pool, key, J0, aad, aad_len, ciphertext, plaintext, ct_len, false, calc_tag);
+    uint8_t diff = 0;
+    for (int i = 0; i < 16; ++i) diff |= calc_tag[i] ^ tag[i];
+    return diff == 0;
+}
+
+inline void sm4_gcm_encrypt_parallel(WorkStealingPool& pool, const uint8_t key[16], const uint8_t iv[12],
+    const uint8_t* plaintext, size_t pt_len, const uint8_t* aad, size_t aad_len,
+    uint8_t* ciphertext, uint8_t tag[16]) {
+    GcmKey ctx;
+    gcm_key_init(ctx, key);
+    sm4_gcm_encrypt_parallel(pool, ctx, iv, plaintext, pt_len, aad, aad_len, ciphertext, tag);
+    gcm_key_wipe(ctx);
+}
+
+inline bool sm4_gcm_decrypt_parallel(WorkStealingPool& pool, const uint8_t key[16], const uint8_t iv[12],
+    const uint8_t* ciphertext, size_t ct_len, const uint8_t* aad, size_t aad_len,
+    const uint8_t tag[16], uint8_t* plaintext) {
+    GcmKey ctx;
+    gcm_key_init(ctx, key);
+    bool ok = sm4_gcm_decrypt_parallel(pool, ctx, iv, ciphertext, ct_len, aad, aad_len, tag, plaintext);
+    gcm_key_wipe(ctx);
+    return ok;
+}
+
+// --- SM3树哈希 ---
+// 叶子为leaf_bytes大小的数据块，叶节点 = SM3(0x00 || 数据)，内部节点 = SM3(0x01 || 左 || 右)，
+// 奇数个节点时最后一个直接上移（与RFC 6962的Merkle树结构相同）
+inline std::vector<uint8_t> sm3_tree_hash(WorkStealingPool& pool, const uint8_t* data, size_t len,
+    size_t leaf_bytes = 1 << 20) {
+    size_t leaves = len == 0 ? 1 : (len + leaf_bytes - 1) / leaf_bytes;
+    std::vector<SM3Hash::Digest> level(leaves);
+    parallel_for(pool, 0, leaves, 1, [&](size_t lo, size_t hi) {
+        SM3Hash sm3;
+        const uint8_t leaf_prefix = 0x00;
+        for (size_t i = lo; i < hi; ++i) {
+            size_t offset = i * leaf_bytes;
+            size_t n = len - offset < leaf_bytes ? len - offset : leaf_bytes;
+            sm3.init();
+            sm3.update(&leaf_prefix, 1);
+            sm3.update(data + offset, n);
+            sm3.final(level[i]);
+        }
+    });
+
+    // 内部节点是65字节的定长消息，用不分配内存的一次性接口
+    while (level.size() > 1) {
+        std::vector<SM3Hash::Digest> parent((level.size() + 1) / 2);
+        parallel_for(pool, 0, level.size() / 2, 64, [&](size_t lo, size_t hi) {
+            uint8_t node[65];
+            node[0] = 0x01;
+            for (size_t i = lo; i < hi; ++i) {
+                memcpy(node + 1, level[2 * i].data(), 32);
+                memcpy(node + 33, level[2 * i + 1].data(), 32);
+                SM3Hash::hash(node, sizeof(node), parent[i]);
+            }
+        });
+        if (level.size() % 2) parent.back() = level.back();
+        level.swap(parent);
+    }
+    return std::vector<uint8_t>(level[0].begin(), level[0].end());
+}
+
+// --- 多文件哈希：每个文件一个任务，按固定大小的块增量计算，读不到的文件结果为空 ---
+constexpr size_t HASH_READ_BYTES = 1 << 20;
+
+inline std::vector<std::vector<uint8_t>> sm3_hash_files(WorkStealingPool& pool, const std::vector<std::string>& paths) {
+    std::vector<std::vector<uint8_t>> digests(paths.size());
+    parallel_for(pool, 0, paths.size(), 1, [&](size_t lo, size_t hi) {
+        SM3Hash sm3;
+        std::vector<char> buffer(HASH_READ_BYTES);
+        for (size_t i = lo; i < hi; ++i) {
+            std::ifstream file(paths[i], std::ios::binary);
+            if (!file) continue;
+            sm3.init();
+            while (file) {
+                file.read(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+                sm3.update(reinterpret_cast<const uint8_t*>(buffer.data()), static_cast<size_t>(file.gcount()));
+            }
+            if (file.bad()) continue;
+            digests[i] = sm3.final();
+        }
+    });
+    return digests;
+}
@@ -0,0 +1,234 @@
+#include <iostream>
+#include <string>
+#include <vector>
+#include <thread>
+#include <chrono>
+#include <random>
+#include <sys/wait.h>
+#include "SM4-GCM.h"
+#include "SM4-KeyCache.h"
+#include "SM4-Ring.h"
+using namespace std;
+using namespace SM4_Ring;
+
+// 共享内存任务环的消费者与自测
+// 消费者按密钥缓存GCM上下文（SM4KeyCache），每次取出一批任务在共享数据区里原地SEAL/OPEN
+
+class RingWorker {
+public:
+    explicit RingWorker(JobRing& ring) : ring_(ring), contexts_(MAX_CACHED_KEYS, 1) {}
+
+    uint64_t processed() const { return processed_; }
+
+    void run() {
+        uint32_t ids[64];
+        while (ring_.wait_for_work()) {
+            size_t n;
+            while ((n = ring_.poll(ids, 64)) > 0) {
+                for (size_t i = 0; i < n; ++i) {
+                    process(ids[i]);
+                    ring_.complete(ids[i]);
+                }
+                processed_ += n;
+            }
+        }
+    }
+
+private:
+    static constexpr size_t MAX_CACHED_KEYS = 1024;
+
+    JobRing& ring_;
+    SM4KeyCache contexts_;   // 只有消费者线程访问，单分片
+    uint64_t processed_ = 0;
+
+    void process(uint32_t id) {
+        RingJob& job = ring_.job(id);
+        // 描述符在生产者可写的共享内存里：先取到本地再检查，之后只用本地值
+        const uint16_t op = job.op;
+        const uint64_t offset = job.offset;
+        const uint32_t aad_len = job.aad_len;
+        const uint32_t length = job.length;
+        if ((op != OP_GCM_SEAL && op != OP_GCM_OPEN) ||
+            !ring_.job_data_valid(id, offset, uint64_t(aad_len) + length)) {
+            job.status = STATUS_BAD_REQUEST;
+            return;
+        }
+
+        SM4KeyCache::Context context = contexts_.get(job.key);
+        const GcmKey& ctx = *context;
+        uint8_t* aad = ring_.data(offset);
+        uint8_t* text = aad + aad_len;
+
+        uint8_t J0[16], ctr0[16];
+        gcm_make_j0(job.iv, J0);
+        memcpy(ctr0, J0, 16);
+        gcm_counter_add(ctr0, 1);
+
+        if (op == OP_GCM_SEAL) {
+            ctr_crypt(ctr0, ctx.rk, text, text, length);
+            gcm_compute_tag(ctx, J0, aad, aad_len, text, length, job.tag);
+            job.status = STATUS_OK;
+        } else {
+            uint8_t tag[16];
+            gcm_compute_tag(ctx, J0, aad, aad_len, text, length, tag);
+            uint8_t diff = 0;
+            for (int i = 0; i < 16; ++i) diff |= tag[i] ^ job.tag[i];
+            if (diff == 0) ctr_crypt(ctr0, ctx.rk, text, text, length);
+            job.status = diff == 0 ? STATUS_OK : STATUS_AUTH_FAILED;
+        }
+    }
+};
+
+// --- 自测：多个子进程按名字映射同一环，并发提交100字节消息的SEAL/OPEN ---
+constexpr uint32_t JOBS_PER_PRODUCER = 8;
+constexpr size_t MESSAGE_BYTES = 100;
+constexpr size_t AAD_BYTES = 13;
+
+int producer_process(const string& name, uint32_t producer, int messages) {
+    JobRing ring;
+    if (!ring.attach(name)) return 2;
+    mt19937 rng(producer + 1);
+    const size_t stride = AAD_BYTES + MESSAGE_BYTES;
+    uint8_t* area = ring.producer_data(producer);
+    uint64_t area_offset = ring.producer_offset(producer);
+
+    // 同时保持JOBS_PER_PRODUCER个任务在途
+    vector<vector<uint8_t>> plain(JOBS_PER_PRODUCER, vector<uint8_t>(stride));
+    for (int sent = 0; sent < messages; sent += JOBS_PER_PRODUCER) {
+        for (uint32_t j = 0; j < JOBS_PER_PRODUCER; ++j) {
+            uint32_t id = ring.job_id(producer, j);
+            RingJob& job = ring.job(id);
+            job.op = OP_GCM_SEAL;
+            job.aad_len = AAD_BYTES;
+            job.length = MESSAGE_BYTES;
+            job.offset = area_offset + j * stride;
+            for (uint8_t& b : job.key) b = static_cast<uint8_t>(rng() % 4);   // 少量密钥，命中上下文缓存
+            for (uint8_t& b : job.iv) b = static_cast<uint8_t>(rng());
+            for (uint8_t& b : plain[j]) b = static_cast<uint8_t>(rng());
+            memcpy(area + j * stride, plain[j].data(), stride);
+            while (!ring.submit(id)) this_thread::yield();
+        }
+        for (uint32_t j = 0; j < JOBS_PER_PRODUCER; ++j) {
+            uint32_t id = ring.job_id(producer, j);
+            ring.wait(id);
+            RingJob& job = ring.job(id);
+            vector<uint8_t> expected(MESSAGE_BYTES);
+            uint8_t tag[16];
+            sm4_gcm_encrypt(job.key, job.iv, plain[j].data() + AAD_BYTES, MESSAGE_BYTES,
+                            plain[j].data(), AAD_BYTES, expected.data(), tag);
+            if (job.status != STATUS_OK || memcmp(area + j * stride + AAD_BYTES, expected.data(), MESSAGE_BYTES) != 0 ||
+                memcmp(job.tag, tag, 16) != 0) {
+                return 1;
+            }
+
+            // 每批第一条再原地OPEN回来，篡改TAG的那条必须失败
+            if (j < 2) {
+                job.op = OP_GCM_OPEN;
+                if (j == 1) job.tag[0] ^= 1;
+                while (!ring.submit(id)) this_thread::yield();
+                ring.wait(id);
+                bool opened = job.status == STATUS_OK && memcmp(area + j * stride, plain[j].data(), stride) == 0;
+                if (j == 0 ? !opened : job.status != STATUS_AUTH_FAILED) return 1;
+            }
+        }
+    }
+    return 0;
+}
+
+// 越界请求：偏移指向别的生产者分区、偏移加长度溢出、长度超出分区、非法操作码都应得到STATUS_BAD_REQUEST；
+// 超出描述符表的编号应被消费者丢弃，之后正常任务照常完成
+int bad_request_process(const string& name, uint32_t producer) {
+    JobRing ring;
+    if (!ring.attach(name)) return 2;
+    const uint64_t begin = ring.producer_offset(producer);
+    const uint64_t other = ring.producer_offset((producer + 1) % ring.producers());
+    struct Case { uint16_t op; uint64_t offset; uint32_t aad_len; uint32_t length; };
+    const Case cases[] = {
+        { OP_GCM_SEAL, other, 0, 16 },
+        { OP_GCM_SEAL, UINT64_MAX - 8, 0, 16 },
+        { OP_GCM_OPEN, begin, AAD_BYTES, static_cast<uint32_t>(ring.data_per_producer()) },
+        { OP_GCM_SEAL, begin, UINT32_MAX, UINT32_MAX },
+        { 7, begin, 0, 16 },
+    };
+    uint32_t id = ring.job_id(producer, 0);
+    RingJob& job = ring.job(id);
+    memset(job.key, 0, sizeof(job.key));
+    memset(job.iv, 0, sizeof(job.iv));
+    for (const Case& c : cases) {
+        job.op = c.op;
+        job.offset = c.offset;
+        job.aad_len = c.aad_len;
+        job.length = c.length;
+        job.status = STATUS_OK;
+        while (!ring.submit(id)) this_thread::yield();
+        ring.wait(id);
+        if (job.status != STATUS_BAD_REQUEST) return 1;
+    }
+
+    while (!ring.enqueue(ring.job_count())) this_thread::yield();
+    while (!ring.enqueue(UINT32_MAX)) this_thread::yield();
+
+    uint8_t* area = ring.producer_data(producer);
+    memset(area, 0x5a, AAD_BYTES + MESSAGE_BYTES);
+    job.op = OP_GCM_SEAL;
+    job.offset = begin;
+    job.aad_len = AAD_BYTES;
+    job.length = MESSAGE_BYTES;
+    while (!ring.submit(id)) this_thread::yield();
+    ring.wait(id);
+    vector<uint8_t> plain(AAD_BYTES + MESSAGE_BYTES, 0x5a), expected(MESSAGE_BYTES);
+    uint8_t tag[16];
+    sm4_gcm_encrypt(job.key, job.iv, plain.data() + AAD_BYTES, MESSAGE_BYTES, plain.data(), AAD_BYTES,
+                    expected.data(), tag);
+    return job.status == STATUS_OK && memcmp(area + AAD_BYTES, expected.data(), MESSAGE_BYTES) == 0 &&
+           memcmp(job.tag, tag, 16) == 0 ? 0 : 1;
+}
+
+void run_selftest(uint32_t producers, int messages) {
+    cout << "=== SM4-GCM Shared-Memory Ring Self-Test ===\n";
+    string name = "/sm4-ring-" + to_string(getpid());
+    JobRing ring;
+    // 最后一个分区留给发送越界请求的进程
+    if (!ring.create(name, 256, producers + 1, JOBS_PER_PRODUCER, JOBS_PER_PRODUCER * (AAD_BYTES + MESSAGE_BYTES))) {
+        cout << "cannot create shared memory " << name << endl;
+        return;
+    }
+    RingWorker worker(ring);
+    thread consumer(&RingWorker::run, &worker);
+
+    auto start = chrono::high_resolution_clock::now();
+    vector<pid_t> children;
+    for (uint32_t p = 0; p < producers; ++p) {
+        pid_t pid = fork();
+        if (pid == 0) {
+            _exit(producer_process(name, p, messages));
+        }
+        children.push_back(pid);
+    }
+    pid_t bad_pid = fork();
+    if (bad_pid == 0) {
+        _exit(bad_request_process(name, producers));
+    }
+    bool ok = true;
+    for (pid_t pid : children) {
+        int status = 0;
+        waitpid(pid, &status, 0);
+        ok = ok && WIFEXITED(status) && WEXITSTATUS(status) == 0;
+    }
+    auto end = chrono::high_resolution_clock::now();
+    int bad_status = 0;
+    waitpid(bad_pid, &bad_status, 0);
+    ring.shutdown();
+    consumer.join();
+
+    double seconds = chrono::duration<double>(end - start).count();
+    cout << producers << " producer processes x " << messages << " messages: " << (ok ? "Passed" : "Failed") << "\n"
+         << "Jobs/s: " << worker.processed() / seconds << endl;
+    bool rejected = WIFEXITED(bad_status) && WEXITSTATUS(bad_status) == 0 && ring.rejected() == 2;
+    cout << "Out-of-bounds offsets and job ids rejected: " << (rejected ? "Passed" : "Failed") << endl;
+}
+
+int main() {
+    run_selftest(4, 20000);
+    return 0;
+}
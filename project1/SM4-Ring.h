@@ -0,0 +1,306 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <ctime>
+#include <fcntl.h>
+#include <linux/futex.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+// 共享内存中的无锁多生产者/单消费者任务环（Linux）
+// 生产者在自己的数据分区里准备好消息，把任务描述符的编号放进环；消费者原地加解密后置完成标志，
+// 需要时用futex唤醒等待方。提交和完成都不经过系统调用，只有一方睡眠时才需要FUTEX_WAKE
+namespace SM4_Ring {
+
+constexpr uint32_t MAGIC = 0x534d3452;   // "SM4R"
+
+enum Op : uint16_t {
+    OP_GCM_SEAL = 1,   // 数据区为 AAD || 明文，明文原地加密，TAG写入描述符
+    OP_GCM_OPEN = 2,   // 数据区为 AAD || 密文，认证通过后原地解密
+};
+
+enum Status : uint16_t {
+    STATUS_OK = 0,
+    STATUS_AUTH_FAILED = 1,
+    STATUS_BAD_REQUEST = 2,
+};
+
+// 任务描述符：归某个生产者所有，数据位于该生产者的数据分区
+struct alignas(64) RingJob {
+    uint16_t op;
+    uint16_t status;
+    uint32_t aad_len;
+    uint32_t length;        // 明文/密文长度，不含AAD
+    uint64_t offset;        // 数据在共享区中的偏移
+    uint8_t key[16];
+    uint8_t iv[12];
+    uint8_t tag[16];
+    std::atomic<uint32_t> done;      // futex字：0提交中，1完成
+    std::atomic<uint32_t> waiting;   // 生产者已睡眠在done上
+};
+
+struct RingSlot {
+    std::atomic<uint64_t> seq;   // Vyukov有界队列的槽序号
+    uint32_t job;
+};
+
+struct RingHeader {
+    uint32_t magic;
+    uint32_t slot_count;          // 2的幂
+    uint32_t producers;
+    uint32_t jobs_per_producer;
+    uint64_t data_per_producer;
+    uint64_t total_bytes;
+    alignas(64) std::atomic<uint64_t> enqueue_pos;
+    alignas(64) uint64_t dequeue_pos;           // 只有消费者访问
+    alignas(64) std::atomic<uint32_t> doorbell; // futex字：每次提交加1
+    std::atomic<uint32_t> consumer_sleeping;
+    std::atomic<uint32_t> shutdown;
+};
+
+inline long futex(std::atomic<uint32_t>* word, int op, uint32_t value) {
+    static_assert(sizeof(std::atomic<uint32_t>) == sizeof(uint32_t), "futex word must be 32-bit");
+    timespec timeout = { 0, 100 * 1000 * 1000 };   // 防止错过唤醒后永久睡眠
+    return syscall(SYS_futex, reinterpret_cast<uint32_t*>(word), op, value,
+                   op == FUTEX_WAIT ? &timeout : nullptr, nullptr, 0);
+}
+
+class JobRing {
+public:
+    static constexpr int SPIN_COUNT = 2000;
+
+    JobRing() = default;
+    JobRing(const JobRing&) = delete;
+    JobRing& operator=(const JobRing&) = delete;
+
+    ~JobRing() {
+        if (base_ != MAP_FAILED) munmap(base_, bytes_);
+        if (owner_) shm_unlink(name_.c_str());
+    }
+
+    // 创建共享内存区（name形如"/sm4-ring"），创建者退出时删除
+    bool create(const std::string& name, uint32_t slot_count, uint32_t producers,
+                uint32_t jobs_per_producer, uint64_t data_per_producer) {
+        if (slot_count == 0 || (slot_count & (slot_count - 1)) != 0) return false;
+        name_ = name;
+        shm_unlink(name.c_str());
+        int fd = shm_open(name.c_str(), O_RDWR | O_CREAT | O_EXCL, 0600);
+        if (fd < 0) return false;
+        owner_ = true;
+
+        uint64_t data_per = (data_per_producer + 63) & ~uint64_t(63);
+        bytes_ = layout(slot_count, producers * jobs_per_producer) + data_per * producers;
+        bool ok = ftruncate(fd, static_cast<off_t>(bytes_)) == 0 && map(fd);
+        close(fd);
+        if (!ok) return false;
+
+        header_->magic = MAGIC;
+        header_->slot_count = slot_count;
+        header_->producers = producers;
+        header_->jobs_per_producer = jobs_per_producer;
+        header_->data_per_producer = data_per;
+        header_->total_bytes = bytes_;
+        header_->enqueue_pos.store(0);
+        header_->dequeue_pos = 0;
+        header_->doorbell.store(0);
+        header_->consumer_sleeping.store(0);
+        header_->shutdown.store(0);
+        locate();
+        for (uint32_t i = 0; i < slot_count; ++i) slots_[i].seq.store(i);
+        return true;
+    }
+
+    // 其他进程按名字映射同一区域
+    bool attach(const std::string& name) {
+        int fd = shm_open(name.c_str(), O_RDWR, 0);
+        if (fd < 0) return false;
+        struct stat st;
+        bool ok = fstat(fd, &st) == 0;
+        bytes_ = static_cast<size_t>(st.st_size);
+        ok = ok && bytes_ >= sizeof(RingHeader) && map(fd);
+        close(fd);
+        if (!ok || header_->magic != MAGIC) return false;
+        locate();
+        return data_offset_ + data_per_producer_ * producers_ <= bytes_;
+    }
+
+    uint32_t producers() const { return producers_; }
+    uint32_t jobs_per_producer() const { return jobs_per_producer_; }
+    uint64_t data_per_producer() const { return data_per_producer_; }
+    uint32_t job_count() const { return producers_ * jobs_per_producer_; }
+
+    uint32_t job_id(uint32_t producer, uint32_t index) const {
+        return producer * jobs_per_producer_ + index;
+    }
+
+    RingJob& job(uint32_t id) { return jobs_[id]; }
+
+    // 生产者数据分区的起始地址与偏移
+    uint8_t* producer_data(uint32_t producer) { return data(producer_offset(producer)); }
+    uint64_t producer_offset(uint32_t producer) const {
+        return data_offset_ + producer * data_per_producer_;
+    }
+    uint8_t* data(uint64_t offset) { return static_cast<uint8_t*>(base_) + offset; }
+
+    // [offset, offset+bytes)是否落在任务id所属生产者的数据分区内；
+    // 描述符由生产者填写，消费者使用前必须检查，不能信任其中的偏移和长度
+    bool job_data_valid(uint32_t id, uint64_t offset, uint64_t bytes) const {
+        uint64_t begin = producer_offset(id / jobs_per_producer_);
+        uint64_t end = begin + data_per_producer_;
+        return offset >= begin && offset <= end && bytes <= end - offset;
+    }
+
+    // --- 生产者 ---
+
+    // 重置完成标志后入队；环满时返回false
+    bool submit(uint32_t id) {
+        RingJob& j = jobs_[id];
+        j.done.store(0, std::memory_order_relaxed);
+        j.waiting.store(0, std::memory_order_relaxed);
+        return enqueue(id);
+    }
+
+    // 只把编号放进环，不检查也不碰描述符（自测用它模拟越界的编号）
+    bool enqueue(uint32_t id) {
+        const uint64_t mask = slot_mask_;
+        uint64_t pos = header_->enqueue_pos.load(std::memory_order_relaxed);
+        for (;;) {
+            RingSlot& slot = slots_[pos & mask];
+            uint64_t seq = slot.seq.load(std::memory_order_acquire);
+            int64_t diff = static_cast<int64_t>(seq) - static_cast<int64_t>(pos);
+            if (diff == 0) {
+                if (header_->enqueue_pos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    slot.job = id;
+                    slot.seq.store(pos + 1, std::memory_order_release);
+                    break;
+                }
+            } else if (diff < 0) {
+                return false;
+            } else {
+                pos = header_->enqueue_pos.load(std::memory_order_relaxed);
+            }
+        }
+
+        header_->doorbell.fetch_add(1);
+        if (header_->consumer_sleeping.load()) {
+            futex(&header_->doorbell, FUTEX_WAKE, 1);
+        }
+        return true;
+    }
+
+    // 等待任务完成：先自旋，再睡在done上
+    void wait(uint32_t id) {
+        RingJob& j = jobs_[id];
+        for (int i = 0; i < SPIN_COUNT; ++i) {
+            if (j.done.load(std::memory_order_acquire)) return;
+        }
+        j.waiting.store(1);
+        while (!j.done.load()) {
+            futex(&j.done, FUTEX_WAIT, 0);
+        }
+    }
+
+    // --- 消费者 ---
+
+    // 取出最多max个任务编号，不阻塞。超出描述符表的编号直接丢弃并计数，不会交给调用方
+    size_t poll(uint32_t* ids, size_t max) {
+        const uint64_t mask = slot_mask_;
+        size_t n = 0;
+        while (n < max) {
+            uint64_t pos = header_->dequeue_pos;
+            RingSlot& slot = slots_[pos & mask];
+            if (slot.seq.load(std::memory_order_acquire) != pos + 1) break;
+            uint32_t id = slot.job;
+            if (id < job_count()) ids[n++] = id;
+            else ++rejected_;
+            slot.seq.store(pos + mask + 1, std::memory_order_release);
+            header_->dequeue_pos = pos + 1;
+        }
+        return n;
+    }
+
+    // poll丢弃的非法编号数
+    uint64_t rejected() const { return rejected_; }
+
+    void complete(uint32_t id) {
+        RingJob& j = jobs_[id];
+        j.done.store(1);
+        if (j.waiting.load()) {
+            futex(&j.done, FUTEX_WAKE, 1);
+        }
+    }
+
+    // 环空时睡眠，直到有新提交或关闭；返回false表示已关闭
+    bool wait_for_work() {
+        const uint64_t mask = slot_mask_;
+        for (int i = 0; i < SPIN_COUNT; ++i) {
+            if (header_->shutdown.load()) return false;
+            if (slots_[header_->dequeue_pos & mask].seq.load(std::memory_order_acquire) == header_->dequeue_pos + 1)
+                return true;
+        }
+        header_->consumer_sleeping.store(1);
+        uint32_t bell = header_->doorbell.load();
+        if (slots_[header_->dequeue_pos & mask].seq.load(std::memory_order_acquire) != header_->dequeue_pos + 1 &&
+            !header_->shutdown.load()) {
+            futex(&header_->doorbell, FUTEX_WAIT, bell);
+        }
+        header_->consumer_sleeping.store(0);
+        return !header_->shutdown.load();
+    }
+
+    void shutdown() {
+        header_->shutdown.store(1);
+        header_->doorbell.fetch_add(1);
+        futex(&header_->doorbell, FUTEX_WAKE, 1);
+    }
+
+private:
+    std::string name_;
+    bool owner_ = false;
+    void* base_ = MAP_FAILED;
+    size_t bytes_ = 0;
+    RingHeader* header_ = nullptr;
+    RingSlot* slots_ = nullptr;
+    RingJob* jobs_ = nullptr;
+    uint64_t data_offset_ = 0;
+    uint64_t rejected_ = 0;
+
+    // 布局参数在映射时复制一份，之后共享区里的头部被改写也不影响下标和偏移的计算
+    uint64_t slot_mask_ = 0;
+    uint32_t producers_ = 0;
+    uint32_t jobs_per_producer_ = 0;
+    uint64_t data_per_producer_ = 0;
+
+    static uint64_t align64(uint64_t n) { return (n + 63) & ~uint64_t(63); }
+
+    static uint64_t layout(uint32_t slot_count, uint32_t jobs) {
+        return align64(sizeof(RingHeader)) + align64(sizeof(RingSlot) * slot_count) + sizeof(RingJob) * jobs;
+    }
+
+    bool map(int fd) {
+        base_ = mmap(nullptr, bytes_, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        header_ = static_cast<RingHeader*>(base_);
+        return base_ != MAP_FAILED;
+    }
+
+    // 按头部参数定位槽数组、描述符表和数据区
+    void locate() {
+        slot_mask_ = header_->slot_count - 1;
+        producers_ = header_->producers;
+        jobs_per_producer_ = header_->jobs_per_producer;
+        data_per_producer_ = header_->data_per_producer;
+        uint8_t* p = static_cast<uint8_t*>(base_);
+        uint64_t slots_offset = align64(sizeof(RingHeader));
+        slots_ = reinterpret_cast<RingSlot*>(p + slots_offset);
+        jobs_ = reinterpret_cast<RingJob*>(p + slots_offset + align64(sizeof(RingSlot) * (slot_mask_ + 1)));
+        data_offset_ = layout(static_cast<uint32_t>(slot_mask_ + 1), job_count());
+    }
+};
+
+} // namespace SM4_Ring
@@ -0,0 +1,367 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <condition_variable>
+#include <cstring>
+#include <functional>
+#include <mutex>
+#include <new>
+#include <streambuf>
+#include <thread>
+#include "SM4-Core.h"
+#include "SM4-GCM.h"
+#include "SM4-Arena.h"
+
+// SM4加解密streambuf：套在任意std::streambuf外面，对iostream透明地做CTR/GCM加解密
+// 两块64字节对齐、大小为8分组整数倍的缓冲区轮流使用：一块交给后台线程加解密并读写底层流，
+// 另一块同时作为用户的put/get区，数据在缓冲区内原地加解密，不再额外拷贝
+
+enum class SM4StreamMode { CTR, GCM };
+
+// CTR（128位计数器）/GCM（inc32 + GHASH）的流式加解密状态，支持任意长度的连续调用
+class SM4StreamCipher {
+public:
+    ~SM4StreamCipher() {
+        gcm_wipe(rk_, sizeof(rk_));
+        gcm_wipe(counter_, sizeof(counter_));
+        gcm_wipe(keystream_, sizeof(keystream_));
+    }
+
+    // CTR的iv为16字节初始计数器，GCM的iv为12字节
+    void start(SM4StreamMode mode, const uint8_t key[16], const uint8_t* iv) {
+        mode_ = mode;
+        if (mode == SM4StreamMode::GCM) {
+            gcm_.start(key, iv);
+        } else {
+            SM4_Core::expand_key(key, rk_);
+            memcpy(counter_, iv, 16);
+            ks_pos_ = 16;
+        }
+    }
+
+    void crypt(const uint8_t* in, uint8_t* out, size_t len, bool encrypt) {
+        if (mode_ == SM4StreamMode::GCM) {
+            gcm_.crypt(in, out, len, encrypt);
+            return;
+        }
+
+        while (len > 0 && ks_pos_ < 16) {
+            *out++ = *in++ ^ keystream_[ks_pos_++];
+            --len;
+        }
+        while (len >= 16) {
+            size_t blocks = len / 16 < BATCH_BLOCKS ? len / 16 : BATCH_BLOCKS;
+            for (size_t b = 0; b < blocks; ++b) {
+                memcpy(keystream_ + b * 16, counter_, 16);
+                SM4_Core::counter128_add(counter_, 1);
+            }
+            SM4_Core::crypt_blocks(keystream_, keystream_, blocks, rk_);
+            for (size_t i = 0; i < blocks * 16; ++i)
+                out[i] = in[i] ^ keystream_[i];
+            in += blocks * 16;
+            out += blocks * 16;
+            len -= blocks * 16;
+        }
+        if (len) {
+            SM4_Core::crypt_block(counter_, keystream_, rk_);
+            SM4_Core::counter128_add(counter_, 1);
+            for (ks_pos_ = 0; ks_pos_ < len; ++ks_pos_)
+                out[ks_pos_] = in[ks_pos_] ^ keystream_[ks_pos_];
+        }
+    }
+
+    // 仅GCM：输出TAG，之后清除GCM状态
+    void finish(uint8_t tag[16]) {
+        gcm_.finish(tag);
+        gcm_.wipe();
+    }
+
+private:
+    static constexpr size_t BATCH_BLOCKS = 64;
+
+    SM4StreamMode mode_ = SM4StreamMode::CTR;
+    GcmStream gcm_;
+    uint32_t rk_[32];
+    uint8_t counter_[16];
+    alignas(64) uint8_t keystream_[BATCH_BLOCKS * 16];   // 剩余密钥流在前16字节，ks_pos_之前已用
+    size_t ks_pos_ = 16;
+};
+
+// 每个streambuf一个常驻后台线程：双缓冲同一时刻最多一个任务在途，用一个槽交接，
+// 不必每块都新建线程。body在构造时给定，post()只传入本次的缓冲区和长度
+template <typename R>
+class SM4StreamWorker {
+public:
+    using Body = std::function<R(uint8_t*, size_t)>;
+
+    explicit SM4StreamWorker(Body body) : body_(std::move(body)), thread_(&SM4StreamWorker::loop, this) {}
+
+    ~SM4StreamWorker() {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            stop_ = true;
+        }
+        cv_.notify_all();
+        thread_.join();
+    }
+
+    SM4StreamWorker(const SM4StreamWorker&) = delete;
+    SM4StreamWorker& operator=(const SM4StreamWorker&) = delete;
+
+    // 交给后台线程处理；上一个任务的结果必须已经用wait()取走
+    void post(uint8_t* data, size_t len) {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            data_ = data;
+            len_ = len;
+            state_ = State::QUEUED;
+        }
+        pending_ = true;
+        cv_.notify_all();
+    }
+
+    // 是否有尚未取走结果的任务（只由提交方调用）
+    bool pending() const {
+        return pending_;
+    }
+
+    R wait() {
+        std::unique_lock<std::mutex> lock(mutex_);
+        cv_.wait(lock, [this] { return state_ == State::DONE; });
+        state_ = State::IDLE;
+        pending_ = false;
+        return result_;
+    }
+
+private:
+    enum class State { IDLE, QUEUED, DONE };
+
+    Body body_;
+    std::mutex mutex_;
+    std::condition_variable cv_;
+    State state_ = State::IDLE;
+    bool stop_ = false;
+    bool pending_ = false;
+    uint8_t* data_ = nullptr;
+    size_t len_ = 0;
+    R result_{};
+    std::thread thread_;   // 最后初始化，线程启动时其他成员均已就绪
+
+    void loop() {
+        std::unique_lock<std::mutex> lock(mutex_);
+        for (;;) {
+            cv_.wait(lock, [this] { return stop_ || state_ == State::QUEUED; });
+            if (stop_) return;
+            lock.unlock();
+            R result = body_(data_, len_);
+            lock.lock();
+            result_ = result;
+            state_ = State::DONE;
+            cv_.notify_all();
+        }
+    }
+};
+
+// 两块缓冲区的分配与释放，取自SecureArena（64字节对齐、锁定内存、释放时清零）
+class SM4StreamBuffers {
+public:
+    static constexpr size_t BUFFER_BYTES = 64 * 1024 - 128;   // 8分组内核的整数倍，加上16字节尾部正好是64KB大小类
+
+    SM4StreamBuffers() {
+        for (uint8_t*& buffer : buffers_) {
+            buffer = static_cast<uint8_t*>(SecureArena::global().allocate(BUFFER_BYTES + 16));
+        }
+    }
+
+    ~SM4StreamBuffers() {
+        for (uint8_t* buffer : buffers_) {
+            SecureArena::global().deallocate(buffer, BUFFER_BYTES + 16);
+        }
+    }
+
+    SM4StreamBuffers(const SM4StreamBuffers&) = delete;
+    SM4StreamBuffers& operator=(const SM4StreamBuffers&) = delete;
+
+protected:
+    uint8_t* buffers_[2];
+};
+
+// 加密方向：写入明文，密文写到sink；GCM在finish()时把TAG追加在密文之后
+// GCM单条消息最多GCM_MAX_TEXT_BYTES字节，写到上限后overflow/sync失败，finish()返回false
+class SM4EncryptBuf : public std::streambuf, private SM4StreamBuffers {
+public:
+    SM4EncryptBuf(std::streambuf* sink, SM4StreamMode mode, const uint8_t key[16], const uint8_t* iv)
+        : sink_(sink), mode_(mode) {
+        cipher_.start(mode, key, iv);
+        set_put_area();
+    }
+
+    ~SM4EncryptBuf() override {
+        finish();
+    }
+
+    // 写出剩余数据（GCM再写TAG），之后不能再写入；返回整个过程是否成功
+    bool finish() {
+        if (finished_) return ok_;
+        sync();
+        if (mode_ == SM4StreamMode::GCM && ok_) {
+            uint8_t tag[16];
+            cipher_.finish(tag);
+            ok_ = sink_->sputn(reinterpret_cast<const char*>(tag), 16) == 16 && sink_->pubsync() == 0;
+        }
+        finished_ = true;
+        setp(nullptr, nullptr);
+        return ok_;
+    }
+
+protected:
+    int_type overflow(int_type ch) override {
+        if (finished_ || !submit()) return traits_type::eof();
+        if (!traits_type::eq_int_type(ch, traits_type::eof())) {
+            *pptr() = traits_type::to_char_type(ch);
+            pbump(1);
+        }
+        return traits_type::not_eof(ch);
+    }
+
+    // 提交当前缓冲区（可以不满一个分组）并等待写完
+    int sync() override {
+        if (finished_) return ok_ ? 0 : -1;
+        if (!submit() || !wait()) return -1;
+        return sink_->pubsync() == 0 ? 0 : -1;
+    }
+
+private:
+    std::streambuf* sink_;
+    SM4StreamMode mode_;
+    SM4StreamCipher cipher_;
+    int active_ = 0;
+    uint64_t text_len_ = 0;   // 已提交加密的字节数
+    bool ok_ = true;
+    bool finished_ = false;
+    // 后台线程：原地加密一块并写到sink；最后声明，先于其他成员析构
+    SM4StreamWorker<bool> worker_{[this](uint8_t* data, size_t len) {
+        cipher_.crypt(data, data, len, true);
+        return sink_->sputn(reinterpret_cast<const char*>(data), static_cast<std::streamsize>(len)) ==
+               static_cast<std::streamsize>(len);
+    }};
+
+    void set_put_area() {
+        char* begin = reinterpret_cast<char*>(buffers_[active_]);
+        setp(begin, begin + BUFFER_BYTES);
+    }
+
+    bool wait() {
+        if (worker_.pending() && !worker_.wait()) ok_ = false;
+        return ok_;
+    }
+
+    // 等上一块写完，然后把当前块交给后台线程原地加密并写出，用户切换到另一块继续写
+    bool submit() {
+        if (!wait()) return false;
+        size_t len = static_cast<size_t>(pptr() - pbase());
+        if (len == 0) return true;
+        if (mode_ == SM4StreamMode::GCM && !gcm_length_ok(text_len_ + len)) {
+            ok_ = false;
+            return false;
+        }
+        text_len_ += len;
+        worker_.post(buffers_[active_], len);
+        active_ ^= 1;
+        set_put_area();
+        return true;
+    }
+};
+
+// 解密方向：从source读密文，读出明文；GCM密文末尾16字节为TAG
+// GCM的最后一块要等TAG验证通过才交给用户，但之前的块在验证前已经可读，
+// 读到流结束后必须检查authenticated()才能信任全部数据；密文超过GCM长度上限时提前结束且不认证
+class SM4DecryptBuf : public std::streambuf, private SM4StreamBuffers {
+public:
+    SM4DecryptBuf(std::streambuf* source, SM4StreamMode mode, const uint8_t key[16], const uint8_t* iv)
+        : source_(source), mode_(mode), hold_(mode == SM4StreamMode::GCM ? 16 : 0) {
+        cipher_.start(mode, key, iv);
+        setg(nullptr, nullptr, nullptr);
+    }
+
+    ~SM4DecryptBuf() override {
+        if (worker_.pending()) worker_.wait();
+    }
+
+    // 仅GCM：读到流结束且TAG验证通过
+    bool authenticated() const {
+        return authenticated_;
+    }
+
+protected:
+    int_type underflow() override {
+        if (gptr() < egptr()) return traits_type::to_int_type(*gptr());
+        if (!started_) {
+            started_ = true;
+            launch(0);
+        }
+        if (!worker_.pending()) return traits_type::eof();
+
+        int filled = active_ ^ 1;
+        size_t len = worker_.wait();
+        if (len == 0) return traits_type::eof();
+        active_ = filled;
+        char* begin = reinterpret_cast<char*>(buffers_[active_]);
+        setg(begin, begin, begin + len);
+        if (!eof_) launch(active_ ^ 1);   // 用户读这一块时后台预读下一块
+        return traits_type::to_int_type(*gptr());
+    }
+
+private:
+    std::streambuf* source_;
+    SM4StreamMode mode_;
+    size_t hold_;              // GCM保留末尾16字节作为可能的TAG
+    SM4StreamCipher cipher_;
+    int active_ = 1;
+    uint8_t tail_[16];
+    size_t tail_len_ = 0;
+    uint64_t text_len_ = 0;    // 已解密的字节数
+    bool started_ = false;
+    bool eof_ = false;
+    bool authenticated_ = false;
+    SM4StreamWorker<size_t> worker_{[this](uint8_t* data, size_t) { return fill(data); }};
+
+    void launch(int index) {
+        worker_.post(buffers_[index], 0);
+    }
+
+    // 后台线程：把上次保留的尾部和新读到的密文放进data，原地解密，返回可读的明文长度
+    size_t fill(uint8_t* data) {
+        memcpy(data, tail_, tail_len_);
+        std::streamsize want = static_cast<std::streamsize>(BUFFER_BYTES + hold_ - tail_len_);
+        std::streamsize got = source_->sgetn(reinterpret_cast<char*>(data + tail_len_), want);
+        size_t total = tail_len_ + static_cast<size_t>(got > 0 ? got : 0);
+        eof_ = got < want;
+
+        size_t len = total > hold_ ? total - hold_ : 0;
+        tail_len_ = total - len;
+        memcpy(tail_, data + len, tail_len_);
+        if (mode_ == SM4StreamMode::GCM && !gcm_length_ok(text_len_ + len)) {
+            eof_ = true;
+            authenticated_ = false;
+            return 0;
+        }
+        text_len_ += len;
+        cipher_.crypt(data, data, len, false);
+
+        if (eof_ && mode_ == SM4StreamMode::GCM) {
+            uint8_t tag[16];
+            cipher_.finish(tag);
+            uint8_t diff = tail_len_ == 16 ? 0 : 1;
+            for (size_t i = 0; i < tail_len_; ++i)
+                diff |= tag[i] ^ tail_[i];
+            authenticated_ = diff == 0;
+            if (!authenticated_) {
+                memset(data, 0, len);   // 不交出未通过认证的最后一块
+                return 0;
+            }
+        }
+        return len;
+    }
+};
@@ -3,8 +3,8 @@
 #include <cstdint>
 #include <algorithm>
 #include <chrono>
-#include <random>
 #include <iomanip>
+#include "SM4-DRBG.h"
 
 using namespace std;
 
@@ -106,11 +106,7 @@ namespace SM4_Impl {
     }
 
     void generate_random_block(array<uint32_t, 4>& block) {
-        random_device rd;
-        mt19937_64 gen(rd());
-        uniform_int_distribution<uint32_t> dist;
-        
-        generate(block.begin(), block.end(), [&]() { return dist(gen); });
+        SM4CtrDrbg::thread_instance().fill(block.data(), block.size() * sizeof(uint32_t));
     }
 
     void display_block(const string& label, const array<uint32_t, 4>& block) {
@@ -3,7 +3,12 @@
 #include <cstring>
 #include <chrono>
 #include <iomanip>
-#include <random>
+#include <vector>
+#if defined(__unix__) || defined(__APPLE__)
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+#include "SM4-DRBG.h"
 
 using namespace std;
 
@@ -56,9 +61,9 @@ void initialize_tables() {
     for (int i = 0; i < 256; ++i) {
         uint32_t t = linear_transform(SBOX[i] << 24);
         T0[i] = t;
-        T1[i] = rotate_left(t, 8);
+        T1[i] = rotate_left(t, 24);
         T2[i] = rotate_left(t, 16);
-        T3[i] = rotate_left(t, 24);
+        T3[i] = rotate_left(t, 8);
     }
 }
 
@@ -115,13 +120,7 @@ void crypt_block(uint32_t block[4], const uint32_t round_keys[32], bool encrypt
 
 // 生成随机数据块
 void generate_random_block(uint32_t block[4]) {
-    random_device rd;
-    mt19937_64 gen(rd());
-    uniform_int_distribution<uint32_t> dist;
-    
-    for (int i = 0; i < 4; ++i) {
-        block[i] = dist(gen);
-    }
+    SM4CtrDrbg::thread_instance().fill(block, 4 * sizeof(uint32_t));
 }
 
 // 打印数据块
@@ -182,6 +181,75 @@ void benchmark() {
     cout << "Latency: " << (duration.count() * 1e6 / TEST_COUNT) << " μs per block\n";
 }
 
+// 随机数发生器测试：相同种子输出一致，批量输出吞吐量
+void benchmark_drbg() {
+    uint8_t seed[SM4CtrDrbg::SEED_BYTES];
+    for (size_t i = 0; i < sizeof(seed); ++i) {
+        seed[i] = static_cast<uint8_t>(i);
+    }
+    
+    SM4CtrDrbg first(seed), second(seed);
+    uint8_t out1[100], out2[100];
+    first.fill(out1, sizeof(out1));
+    second.fill(out2, sizeof(out2));
+    bool reproducible = memcmp(out1, out2, sizeof(out1)) == 0;
+    first.fill(out2, sizeof(out2));
+    bool advancing = memcmp(out1, out2, sizeof(out1)) != 0;
+    
+    // 已知答案：按SP 800-90A CTR_DRBG（无派生函数、无个性化串）实例化，entropy_input = 00..1f，
+    // 连续两次生成64字节，核对第二次输出（与CAVP的测试方式相同）。期望值由独立的参考实现算出
+    static const uint8_t kat_expected[64] = {
+        0xa0, 0x49, 0xc9, 0xb9, 0xb4, 0x99, 0x15, 0x1f, 0xfc, 0xc2, 0x68, 0xa8, 0x21, 0x4c, 0xe7, 0x0b,
+        0xdc, 0xe2, 0x09, 0xcd, 0x17, 0x48, 0x43, 0xd7, 0x59, 0xd5, 0xbb, 0x69, 0x6b, 0xb1, 0xf0, 0x2e,
+        0x76, 0x3d, 0xea, 0x67, 0xde, 0x65, 0x67, 0x4c, 0xa2, 0xe2, 0x16, 0xba, 0x4a, 0xdb, 0x8c, 0x76,
+        0x88, 0x34, 0x96, 0xda, 0x7b, 0x8a, 0xaf, 0xa4, 0x22, 0x56, 0x41, 0x7c, 0x8f, 0xce, 0xb5, 0xfc,
+    };
+    SM4CtrDrbg kat(seed);
+    uint8_t kat_out[64];
+    kat.fill(kat_out, sizeof(kat_out));
+    kat.fill(kat_out, sizeof(kat_out));
+    bool known_answer = memcmp(kat_out, kat_expected, sizeof(kat_out)) == 0;
+    
+    cout << "\n[SM4-CTR-DRBG Test]\n";
+    cout << "Deterministic seeding: " << (reproducible && advancing ? "passed" : "failed") << endl;
+    cout << "Known-answer (SP 800-90A, no df): " << (known_answer ? "passed" : "failed") << endl;
+
+#if defined(__unix__) || defined(__APPLE__)
+    // fork后父子进程从同一状态继续，各自重播种后输出必须不同
+    SM4CtrDrbg::thread_instance().fill(out1, 16);
+    int fds[2];
+    bool forked = pipe(fds) == 0;
+    pid_t pid = forked ? fork() : -1;
+    if (pid == 0) {
+        SM4CtrDrbg::thread_instance().fill(out1, sizeof(out1));
+        ssize_t written = write(fds[1], out1, sizeof(out1));
+        _exit(written == static_cast<ssize_t>(sizeof(out1)) ? 0 : 1);
+    }
+    bool diverged = false;
+    if (pid > 0) {
+        SM4CtrDrbg::thread_instance().fill(out1, sizeof(out1));
+        diverged = read(fds[0], out2, sizeof(out2)) == static_cast<ssize_t>(sizeof(out2)) &&
+                   memcmp(out1, out2, sizeof(out1)) != 0;
+        waitpid(pid, nullptr, 0);
+    }
+    if (forked) {
+        close(fds[0]);
+        close(fds[1]);
+    }
+    cout << "Fork reseeding: " << (diverged ? "passed" : "failed") << endl;
+#endif
+    
+    constexpr size_t BUFFER_SIZE = 64 * 1024 * 1024;
+    vector<uint8_t> buffer(BUFFER_SIZE);
+    auto start = chrono::high_resolution_clock::now();
+    SM4CtrDrbg::thread_instance().fill(buffer.data(), buffer.size());
+    auto end = chrono::high_resolution_clock::now();
+    
+    chrono::duration<double> duration = end - start;
+    cout << "Generated " << BUFFER_SIZE / (1024 * 1024) << " MB in " << duration.count() << " seconds\n";
+    cout << "Throughput: " << (BUFFER_SIZE / duration.count() / (1024 * 1024)) << " MB/second\n";
+}
+
 } // namespace SM4_Optimized
 
 int main() {
@@ -192,5 +260,6 @@ int main() {
     cout << (success ? "Algorithm verified successfully\n" : "Algorithm verification failed\n");
     
     SM4_Optimized::benchmark();
+    SM4_Optimized::benchmark_drbg();
     return 0;
 }
\ No newline at end of file
@@ -0,0 +1,189 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+// 工作窃取线程池：每个工作线程一个双端队列，自己从尾部压入/取出（后进先出，缓存友好），
+// 空闲线程从其他队列头部窃取（先进先出，偷到的通常是最大的未拆分任务）。
+// 外部线程提交的任务进入注入队列。TaskGroup::wait()在等待期间也会执行任务，递归拆分不会死锁
+class WorkStealingPool {
+public:
+    explicit WorkStealingPool(unsigned threads = std::thread::hardware_concurrency()) {
+        if (threads == 0) threads = 1;
+        for (unsigned i = 0; i < threads; ++i) {
+            queues_.push_back(std::make_unique<Queue>());
+        }
+        for (unsigned i = 0; i < threads; ++i) {
+            workers_.emplace_back([this, i] { worker_loop(i); });
+        }
+    }
+
+    ~WorkStealingPool() {
+        {
+            std::lock_guard<std::mutex> lock(sleep_mutex_);
+            stopping_ = true;
+        }
+        sleep_cv_.notify_all();
+        for (std::thread& t : workers_) t.join();
+    }
+
+    WorkStealingPool(const WorkStealingPool&) = delete;
+    WorkStealingPool& operator=(const WorkStealingPool&) = delete;
+
+    unsigned size() const {
+        return static_cast<unsigned>(workers_.size());
+    }
+
+    // 工作线程内提交到自己的队列尾部，外部线程提交到注入队列
+    void submit(std::function<void()> task) {
+        Queue& queue = tls_pool_ == this ? *queues_[tls_index_] : injector_;
+        {
+            std::lock_guard<std::mutex> lock(queue.mutex);
+            queue.tasks.push_back(std::move(task));
+        }
+        queued_.fetch_add(1);
+        if (sleepers_.load() > 0) {
+            std::lock_guard<std::mutex> lock(sleep_mutex_);
+            sleep_cv_.notify_one();
+        }
+    }
+
+    // 取一个任务执行：自己的队列 -> 注入队列 -> 窃取其他队列；没有任务时返回false
+    bool run_one() {
+        std::function<void()> task;
+        bool found = false;
+        if (tls_pool_ == this) found = pop_back(*queues_[tls_index_], task);
+        if (!found) found = pop_front(injector_, task);
+        if (!found) {
+            size_t start = tls_pool_ == this ? tls_index_ + 1 : 0;
+            for (size_t k = 0; k < queues_.size() && !found; ++k) {
+                found = pop_front(*queues_[(start + k) % queues_.size()], task);
+            }
+            if (found) steals_.fetch_add(1, std::memory_order_relaxed);
+        }
+        if (!found) return false;
+        queued_.fetch_sub(1);
+        task();
+        return true;
+    }
+
+    uint64_t steals() const {
+        return steals_.load();
+    }
+
+private:
+    struct Queue {
+        std::mutex mutex;
+        std::deque<std::function<void()>> tasks;
+    };
+
+    std::vector<std::unique_ptr<Queue>> queues_;
+    Queue injector_;
+    std::vector<std::thread> workers_;
+    std::atomic<size_t> queued_{0};
+    std::atomic<unsigned> sleepers_{0};
+    std::atomic<uint64_t> steals_{0};
+    std::mutex sleep_mutex_;
+    std::condition_variable sleep_cv_;
+    bool stopping_ = false;
+
+    inline static thread_local WorkStealingPool* tls_pool_ = nullptr;
+    inline static thread_local size_t tls_index_ = 0;
+
+    static bool pop_back(Queue& queue, std::function<void()>& task) {
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        if (queue.tasks.empty()) return false;
+        task = std::move(queue.tasks.back());
+        queue.tasks.pop_back();
+        return true;
+    }
+
+    static bool pop_front(Queue& queue, std::function<void()>& task) {
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        if (queue.tasks.empty()) return false;
+        task = std::move(queue.tasks.front());
+        queue.tasks.pop_front();
+        return true;
+    }
+
+    void worker_loop(size_t index) {
+        tls_pool_ = this;
+        tls_index_ = index;
+        for (;;) {
+            if (run_one()) continue;
+            std::unique_lock<std::mutex> lock(sleep_mutex_);
+            sleepers_.fetch_add(1);
+            sleep_cv_.wait(lock, [this] { return stopping_ || queued_.load() > 0; });
+            sleepers_.fetch_sub(1);
+            if (stopping_ && queued_.load() == 0) return;
+        }
+    }
+};
+
+// 一组可等待的任务；wait()期间当前线程帮忙执行池中的任务，第一个异常在wait()处重新抛出
+class TaskGroup {
+public:
+    explicit TaskGroup(WorkStealingPool& pool) : pool_(pool) {}
+
+    ~TaskGroup() {
+        // 析构前必须等任务结束，它们引用了本对象
+        while (outstanding_.load() > 0) {
+            if (!pool_.run_one()) std::this_thread::yield();
+        }
+    }
+
+    TaskGroup(const TaskGroup&) = delete;
+    TaskGroup& operator=(const TaskGroup&) = delete;
+
+    void run(std::function<void()> fn) {
+        outstanding_.fetch_add(1);
+        pool_.submit([this, fn = std::move(fn)] {
+            try {
+                fn();
+            } catch (...) {
+                std::lock_guard<std::mutex> lock(error_mutex_);
+                if (!error_) error_ = std::current_exception();
+            }
+            outstanding_.fetch_sub(1);
+        });
+    }
+
+    void wait() {
+        while (outstanding_.load() > 0) {
+            if (!pool_.run_one()) std::this_thread::yield();
+        }
+        std::lock_guard<std::mutex> lock(error_mutex_);
+        if (error_) std::rethrow_exception(std::exchange(error_, nullptr));
+    }
+
+private:
+    WorkStealingPool& pool_;
+    std::atomic<size_t> outstanding_{0};
+    std::mutex error_mutex_;
+    std::exception_ptr error_;
+};
+
+// 递归二分[begin, end)，区间不大于grain时调用fn(lo, hi)；右半部分作为可被窃取的任务
+template <typename Fn>
+void parallel_for(WorkStealingPool& pool, size_t begin, size_t end, size_t grain, const Fn& fn) {
+    if (grain == 0) grain = 1;
+    if (end - begin <= grain) {
+        if (begin < end) fn(begin, end);
+        return;
+    }
+    size_t mid = begin + (end - begin) / 2;
+    TaskGroup group(pool);
+    group.run([&pool, mid, end, grain, &fn] { parallel_for(pool, mid, end, grain, fn); });
+    parallel_for(pool, begin, mid, grain, fn);
+    group.wait();
+}
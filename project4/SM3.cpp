@@ -1,5 +1,6 @@
 #include <iostream>
 #include <vector>
+#include <array>
 #include <cstring>
 #include <iomanip>
 #include <sstream>
@@ -14,30 +15,43 @@ public:
 
     // 计算字节数组的哈希值
     std::vector<uint8_t> calculateHash(const uint8_t* data, size_t len) {
+        std::vector<uint8_t> hashResult(32);
+        calculateHash(data, len, hashResult.data());
+        return hashResult;
+    }
+
+    // 计算字节数组的哈希值，结果写入调用方提供的32字节数组（不分配内存）
+    void calculateHash(const uint8_t* data, size_t len, std::array<uint8_t, 32>& hashResult) noexcept {
+        calculateHash(data, len, hashResult.data());
+    }
+
+    void calculateHash(const uint8_t* data, size_t len, uint8_t hashResult[32]) noexcept {
         // 初始化哈希缓冲区
         uint32_t hashBuffer[8] = {
             0x7380166F, 0x4914B2B9, 0x172442D7, 0xDA8A0600,
             0xA96F30BC, 0x163138AA, 0xE38DEE4D, 0xB0FB0E4E
         };
 
-        // 对输入数据进行填充处理
-        std::vector<uint8_t> paddedData = addPadding(data, len);
+        // 完整的512位(64字节)分组直接从输入数据处理
+        size_t fullBlocks = len / 64;
+        for (size_t i = 0; i < fullBlocks; i++) {
+            processBlock(hashBuffer, data + i * 64);
+        }
 
-        // 按512位(64字节)分组处理数据
-        for (size_t i = 0; i < paddedData.size(); i += 64) {
-            processBlock(hashBuffer, &paddedData[i]);
+        // 只对最后不足一组的数据进行填充处理
+        uint8_t finalBlocks[128];
+        size_t finalCount = addPadding(data + fullBlocks * 64, len % 64, len, finalBlocks);
+        for (size_t i = 0; i < finalCount; i++) {
+            processBlock(hashBuffer, finalBlocks + i * 64);
         }
 
         // 将哈希结果转换为字节数组
-        std::vector<uint8_t> hashResult(32);
         for (int i = 0; i < 8; i++) {
             hashResult[i*4]   = (hashBuffer[i] >> 24) & 0xFF;
             hashResult[i*4+1] = (hashBuffer[i] >> 16) & 0xFF;
             hashResult[i*4+2] = (hashBuffer[i] >> 8)  & 0xFF;
             hashResult[i*4+3] = hashBuffer[i] & 0xFF;
         }
-
-        return hashResult;
     }
 
 private:
@@ -71,25 +85,22 @@ private:
         return index < 16 ? x ^ y ^ z : (x & y) | ((~x) & z);
     }
 
-    // 数据填充处理
-    std::vector<uint8_t> addPadding(const uint8_t* data, size_t len) {
-        size_t bitLength = len * 8;
-        std::vector<uint8_t> paddedData(data, data + len);
+    // 数据填充处理：tail为最后不足64字节的数据，结果写入out，返回分组数(1或2)
+    size_t addPadding(const uint8_t* tail, size_t tailLength, size_t totalLength, uint8_t out[128]) {
+        uint64_t bitLength = static_cast<uint64_t>(totalLength) * 8;
+        size_t blocks = tailLength + 1 + 8 > 64 ? 2 : 1;
+        memset(out, 0, blocks * 64);
+        memcpy(out, tail, tailLength);
 
         // 添加结束标志位
-        paddedData.push_back(0x80);
-
-        // 填充0直到满足长度要求
-        while ((paddedData.size() * 8 + 64) % 512 != 0) {
-            paddedData.push_back(0x00);
-        }
+        out[tailLength] = 0x80;
 
         // 添加原始数据长度(64位)
-        for (int i = 7; i >= 0; i--) {
-            paddedData.push_back((bitLength >> (8 * i)) & 0xFF);
+        for (int i = 0; i < 8; i++) {
+            out[blocks * 64 - 1 - i] = (bitLength >> (8 * i)) & 0xFF;
         }
 
-        return paddedData;
+        return blocks;
     }
 
     // 消息扩展
@@ -0,0 +1,110 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include "SM3Hash.h"
+#include "SM3MultiBuffer.h"
+
+// HMAC-SM3：HMAC(K, m) = SM3((K ^ opad) || SM3((K ^ ipad) || m))
+// K^ipad、K^opad各占一个完整分组，构造时压缩一次并保存两个链接状态（SM3Hash::Midstate），
+// 之后每条消息只压缩自身的分组和外层的一个分组；短消息（如API请求签名）的压缩次数从4次降到2次。
+// mac_many把同一密钥下的一批消息交给多缓冲SM3：先并行算内层，再并行算外层
+class HmacSm3 {
+public:
+    static constexpr size_t TAG_BYTES = SM3Hash::DIGEST_BYTES;
+    static constexpr size_t BATCH = 64;   // mac_many每轮处理的消息数（内层摘要放在栈上）
+
+    using Tag = SM3Hash::Digest;
+
+    HmacSm3(const uint8_t* key, size_t key_len) noexcept {
+        key_states(key, key_len, inner_, outer_);
+    }
+
+    ~HmacSm3() {
+        volatile uint32_t* p = inner_.state.data();
+        for (int i = 0; i < 8; ++i) p[i] = 0;
+        p = outer_.state.data();
+        for (int i = 0; i < 8; ++i) p[i] = 0;
+    }
+
+    HmacSm3(const HmacSm3&) = default;
+    HmacSm3& operator=(const HmacSm3&) = default;
+
+    // 由密钥算出内外两层的链接状态：长于一个分组的密钥先做一次SM3
+    static void key_states(const uint8_t* key, size_t key_len, SM3Hash::Midstate& inner,
+                           SM3Hash::Midstate& outer) noexcept {
+        uint8_t k[SM3Hash::BLOCK_BYTES] = { 0 };
+        if (key_len > SM3Hash::BLOCK_BYTES) {
+            SM3Hash::hash(key, key_len, k);
+        } else if (key_len > 0) {
+            memcpy(k, key, key_len);
+        }
+        uint8_t pad[SM3Hash::BLOCK_BYTES];
+        for (size_t i = 0; i < sizeof(pad); ++i) pad[i] = k[i] ^ 0x36;
+        inner = { SM3Hash::INITIAL_STATE, SM3Hash::BLOCK_BYTES };
+        SM3Hash::process_block(inner.state, pad);
+        for (size_t i = 0; i < sizeof(pad); ++i) pad[i] = k[i] ^ 0x5c;
+        outer = { SM3Hash::INITIAL_STATE, SM3Hash::BLOCK_BYTES };
+        SM3Hash::process_block(outer.state, pad);
+        volatile uint8_t* v = k;
+        for (size_t i = 0; i < sizeof(k); ++i) v[i] = 0;
+        v = pad;
+        for (size_t i = 0; i < sizeof(pad); ++i) v[i] = 0;
+    }
+
+    const SM3Hash::Midstate& inner() const noexcept { return inner_; }
+    const SM3Hash::Midstate& outer() const noexcept { return outer_; }
+
+    // 一次性计算
+    void mac(const uint8_t* data, size_t len, uint8_t tag[TAG_BYTES]) const noexcept {
+        uint8_t inner_digest[SM3Hash::DIGEST_BYTES];
+        SM3Hash::hash(inner_, data, len, inner_digest);
+        SM3Hash::hash(outer_, inner_digest, sizeof(inner_digest), tag);
+    }
+
+    Tag mac(const uint8_t* data, size_t len) const noexcept {
+        Tag tag;
+        mac(data, len, tag.data());
+        return tag;
+    }
+
+    // 增量计算：start返回已吸收K^ipad的SM3Hash，update消息后交给finish
+    SM3Hash start() const {
+        return SM3Hash(inner_);
+    }
+
+    void finish(SM3Hash& ctx, uint8_t tag[TAG_BYTES]) const noexcept {
+        uint8_t inner_digest[SM3Hash::DIGEST_BYTES];
+        ctx.final(inner_digest);
+        SM3Hash::hash(outer_, inner_digest, sizeof(inner_digest), tag);
+    }
+
+    // 常数时间比较
+    bool verify(const uint8_t* data, size_t len, const uint8_t tag[TAG_BYTES]) const noexcept {
+        uint8_t expected[TAG_BYTES];
+        mac(data, len, expected);
+        uint8_t diff = 0;
+        for (size_t i = 0; i < TAG_BYTES; ++i) diff |= expected[i] ^ tag[i];
+        return diff == 0;
+    }
+
+    // 批量：第i条消息的tag写入tags[i]。每轮BATCH条，内层与外层各走一遍多缓冲SM3
+    void mac_many(const uint8_t* const* data, const size_t* lens, size_t count, Tag* tags) const noexcept {
+        SM3MultiBuffer mb;
+        Tag inner_digests[BATCH];
+        for (size_t base = 0; base < count; base += BATCH) {
+            const size_t n = count - base < BATCH ? count - base : BATCH;
+            for (size_t i = 0; i < n; ++i) mb.submit(inner_, data[base + i], lens[base + i], inner_digests[i].data());
+            mb.flush();
+            for (size_t i = 0; i < n; ++i) {
+                mb.submit(outer_, inner_digests[i].data(), SM3Hash::DIGEST_BYTES, tags[base + i].data());
+            }
+            mb.flush();
+        }
+    }
+
+private:
+    SM3Hash::Midstate inner_;
+    SM3Hash::Midstate outer_;
+};
@@ -0,0 +1,404 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#ifdef __SSSE3__
+#include <immintrin.h>
+#endif
+#if __cplusplus >= 202002L
+#include <span>
+#endif
+#include <vector>
+
+// SM3密码杂凑算法实现类
+class SM3Hash {
+public:
+    static constexpr size_t BLOCK_BYTES = 64;   // 分组大小(字节)
+    static constexpr size_t DIGEST_BYTES = 32;  // 哈希结果长度(字节)
+
+    // 初始值IV
+    static constexpr std::array<uint32_t, 8> INITIAL_STATE = {
+        0x7380166F, 0x4914B2B9, 0x172442D7, 0xDA8A0600,
+        0xA96F30BC, 0x163138AA, 0xE38DEE4D, 0xB0FB0E4E
+    };
+
+    using Digest = std::array<uint8_t, DIGEST_BYTES>;
+
+    // 链接状态（midstate）：压缩完若干整分组后的链接变量及这些分组的字节数。
+    // 许多消息共享较长的公共前缀（域分隔标签、HMAC的ipad/opad分组、SM2的Z_A等）时，
+    // 对前缀只算一次并保存链接状态，每条消息从它继续，不再重复压缩前缀
+    struct Midstate {
+        std::array<uint32_t, 8> state;
+        uint64_t bytes;    // BLOCK_BYTES的整数倍
+    };
+
+    SM3Hash() {
+        init();
+    }
+
+    // 从链接状态开始增量计算，之后update的数据接在前缀之后
+    explicit SM3Hash(const Midstate& prefix) {
+        resume(prefix);
+    }
+
+    // 计算字符串的哈希值
+    std::vector<uint8_t> compute(const std::string& text) {
+        return compute(reinterpret_cast<const uint8_t*>(text.c_str()), text.length());
+    }
+
+    // 计算字节数组的哈希值（会重置增量计算的状态）
+    std::vector<uint8_t> compute(const uint8_t* data, size_t len) {
+        std::vector<uint8_t> result(DIGEST_BYTES);
+        hash(data, len, result.data());
+        return result;
+    }
+
+    // 一次性计算，摘要写入调用方提供的32字节缓冲区：不分配内存、不抛异常，可在多线程紧密循环中使用
+    static void hash(const uint8_t* data, size_t len, uint8_t out[DIGEST_BYTES]) noexcept {
+        if (len == DIGEST_BYTES) {
+            hash32(data, out);
+            return;
+        }
+        if (len == BLOCK_BYTES) {
+            hash64(data, out);
+            return;
+        }
+        std::array<uint32_t, 8> state = INITIAL_STATE;
+        const size_t full = len / BLOCK_BYTES;
+        for (size_t i = 0; i < full; ++i) {
+            process_block(state, data + i * BLOCK_BYTES);
+        }
+        finish(state, data + full * BLOCK_BYTES, len % BLOCK_BYTES, len, out);
+    }
+
+    static void hash(const uint8_t* data, size_t len, Digest& out) noexcept {
+        hash(data, len, out.data());
+    }
+
+    static Digest hash(const uint8_t* data, size_t len) noexcept {
+        Digest out;
+        hash(data, len, out.data());
+        return out;
+    }
+
+#if defined(__cpp_lib_span)
+    static void hash(std::span<const uint8_t> data, std::span<uint8_t, DIGEST_BYTES> out) noexcept {
+        hash(data.data(), data.size(), out.data());
+    }
+#endif
+
+    // 增量计算：init() -> update()若干次 -> final()
+    // 完整分组直接从调用方缓冲区压缩，只在内部保留不足64字节的尾部，不复制整条消息
+    void init() noexcept {
+        state_ = INITIAL_STATE;
+        pending_len_ = 0;
+        total_bytes_ = 0;
+    }
+
+    // 导出当前链接状态。只有已输入的字节数是分组长度的整数倍（没有未压缩的尾部）时才能导出，否则返回false
+    bool export_midstate(Midstate& out) const noexcept {
+        if (pending_len_ != 0) return false;
+        out.state = state_;
+        out.bytes = total_bytes_;
+        return true;
+    }
+
+    // 从链接状态继续（相当于init()后输入了prefix.bytes字节的前缀）
+    void resume(const Midstate& prefix) noexcept {
+        state_ = prefix.state;
+        pending_len_ = 0;
+        total_bytes_ = prefix.bytes;
+    }
+
+    // 由摘要得到链接状态：摘要就是消息填充后最后一个分组压缩完的链接变量，
+    // padded_bytes为原消息填充后的长度。长度扩展攻击即由此在未知消息后续写数据
+    static Midstate midstate_from_digest(const uint8_t digest[DIGEST_BYTES], uint64_t padded_bytes) noexcept {
+        Midstate m;
+        for (int i = 0; i < 8; ++i) m.state[i] = load_be32(digest + 4 * i);
+        m.bytes = padded_bytes;
+        return m;
+    }
+
+    // 一次性计算前缀 || data 的摘要，前缀以链接状态给出
+    static void hash(const Midstate& prefix, const uint8_t* data, size_t len, uint8_t out[DIGEST_BYTES]) noexcept {
+        std::array<uint32_t, 8> state = prefix.state;
+        const size_t full = len / BLOCK_BYTES;
+        for (size_t i = 0; i < full; ++i) {
+            process_block(state, data + i * BLOCK_BYTES);
+        }
+        finish(state, data + full * BLOCK_BYTES, len % BLOCK_BYTES, prefix.bytes + len, out);
+    }
+
+    void update(const uint8_t* data, size_t len) noexcept {
+        total_bytes_ += len;
+        if (pending_len_ > 0) {
+            size_t n = BLOCK_BYTES - pending_len_ < len ? BLOCK_BYTES - pending_len_ : len;
+            std::memcpy(pending_.data() + pending_len_, data, n);
+            pending_len_ += n;
+            data += n;
+            len -= n;
+            if (pending_len_ < BLOCK_BYTES) return;
+            process_block(state_, pending_.data());
+            pending_len_ = 0;
+        }
+        for (; len >= BLOCK_BYTES; data += BLOCK_BYTES, len -= BLOCK_BYTES) {
+            process_block(state_, data);
+        }
+        if (len > 0) std::memcpy(pending_.data(), data, len);
+        pending_len_ = len;
+    }
+
+    void update(const std::string& text) {
+        update(reinterpret_cast<const uint8_t*>(text.data()), text.size());
+    }
+
+    // 填充并输出摘要，之后需重新init()才能计算下一条消息
+    std::vector<uint8_t> final() {
+        std::vector<uint8_t> result(DIGEST_BYTES);
+        final(result.data());
+        return result;
+    }
+
+    void final(uint8_t out[DIGEST_BYTES]) noexcept {
+        finish(state_, pending_.data(), pending_len_, total_bytes_, out);
+    }
+
+    void final(Digest& out) noexcept {
+        final(out.data());
+    }
+
+    // 压缩函数
+    static void process_block(std::array<uint32_t, 8>& buffer, const uint8_t* block) {
+        process_block(buffer, block, [](int) {});
+    }
+
+    // 压缩函数，第j轮迭代后调用round_hook(j)（j为编译期常量）
+    // 供其他算法按轮与SM3交织执行，两条互不依赖的计算链同时占用流水线（见project1/SM4-CBC-HMAC.h）
+    template <typename RoundHook>
+    static void process_block(std::array<uint32_t, 8>& buffer, const uint8_t* block, RoundHook&& round_hook) {
+#ifdef __SSSE3__
+        // SSE消息扩展：从第12轮起每3轮算出后面3个W，与标量轮函数交织执行
+        alignas(16) uint32_t w[MESSAGE_WORDS];
+        load_message_simd(block, w);
+        compress<SSE_SCHEDULE>(buffer, w, round_hook);
+#else
+        // 消息字只保留16个的滑动窗口，W_{j+4}在第j轮现算
+        uint32_t w[16];
+        load_message(block, w);
+        compress<RING_SCHEDULE>(buffer, w, round_hook);
+#endif
+    }
+
+private:
+    std::array<uint32_t, 8> state_;                // 当前链接变量
+    std::array<uint8_t, BLOCK_BYTES> pending_;     // 不足一个分组的尾部
+    size_t pending_len_;
+    uint64_t total_bytes_;                          // 已输入的消息字节数
+
+    // 压缩函数中消息字W的来源
+    enum Schedule {
+        RING_SCHEDULE,       // w为16个字的滑动窗口，W_{j+4}在第j轮现算
+        SSE_SCHEDULE,        // w按下标存放W_0~W_67，由SSE每3轮填入3个
+        CONSTANT_SCHEDULE    // w为已扩展好的W_0~W_67（常量填充分组）
+    };
+
+    template <Schedule S, typename Words, typename RoundHook>
+    static void compress(std::array<uint32_t, 8>& buffer, Words* w, RoundHook& round_hook) {
+        // 初始化压缩变量
+        uint32_t a = buffer[0], b = buffer[1], c = buffer[2], d = buffer[3];
+        uint32_t e = buffer[4], f = buffer[5], g = buffer[6], h = buffer[7];
+
+        // 64轮完全展开：第0~15轮与第16~63轮使用不同的布尔函数
+        rounds<0, S>(a, b, c, d, e, f, g, h, w, round_hook);
+
+        // 更新缓冲区
+        buffer[0] ^= a; buffer[1] ^= b; buffer[2] ^= c; buffer[3] ^= d;
+        buffer[4] ^= e; buffer[5] ^= f; buffer[6] ^= g; buffer[7] ^= h;
+    }
+
+    // 将缓冲区数据转换为字节序列
+    static void store_digest(const std::array<uint32_t, 8>& state, uint8_t out[DIGEST_BYTES]) noexcept {
+        for (size_t i = 0; i < state.size(); ++i) {
+            out[i*4]   = static_cast<uint8_t>(state[i] >> 24);
+            out[i*4+1] = static_cast<uint8_t>(state[i] >> 16);
+            out[i*4+2] = static_cast<uint8_t>(state[i] >> 8);
+            out[i*4+3] = static_cast<uint8_t>(state[i]);
+        }
+    }
+
+    // 填充最后不足一个分组的tail并压缩，输出摘要
+    // 填充只涉及最后一到两个分组：尾部 || 0x80 || 0...0 || 64位大端比特长度
+    static void finish(std::array<uint32_t, 8>& state, const uint8_t* tail, size_t tail_len, uint64_t total_bytes,
+                       uint8_t out[DIGEST_BYTES]) noexcept {
+        std::array<uint8_t, BLOCK_BYTES * 2> last = {};
+        if (tail_len > 0) std::memcpy(last.data(), tail, tail_len);
+        last[tail_len] = 0x80;
+        const size_t blocks = tail_len + 1 + 8 > BLOCK_BYTES ? 2 : 1;
+        const uint64_t bit_len = total_bytes * 8;
+        for (int i = 0; i < 8; ++i) {
+            last[blocks * BLOCK_BYTES - 1 - i] = static_cast<uint8_t>(bit_len >> (8 * i));
+        }
+        for (size_t b = 0; b < blocks; ++b) {
+            process_block(state, last.data() + b * BLOCK_BYTES);
+        }
+        store_digest(state, out);
+    }
+
+    // 循环左移操作（shift取0~31）
+    static constexpr uint32_t left_rotate(uint32_t value, uint32_t shift) {
+        shift &= 31;
+        return shift == 0 ? value : (value << shift) | (value >> (32 - shift));
+    }
+
+    // 置换函数P0
+    static constexpr uint32_t permute0(uint32_t x) {
+        return x ^ left_rotate(x, 9) ^ left_rotate(x, 17);
+    }
+
+    // 置换函数P1
+    static constexpr uint32_t permute1(uint32_t x) {
+        return x ^ left_rotate(x, 15) ^ left_rotate(x, 23);
+    }
+
+    // 第J轮。调用方每轮把变量按(d, a, b, c, h, e, f, g)的次序轮换传入，
+    // 代替逐个移动8个字：每轮只写d、h并旋转b、f，状态始终留在寄存器中。
+    template <int J, Schedule S, typename Words, typename RoundHook>
+    static inline void round(uint32_t a, uint32_t& b, uint32_t c, uint32_t& d,
+                             uint32_t e, uint32_t& f, uint32_t g, uint32_t& h,
+                             Words* w, RoundHook& round_hook) {
+#ifdef __SSSE3__
+        // 第J轮要用W_{J+4}：每3轮提前算出W_{J+4}~W_{J+6}
+        if constexpr (S == SSE_SCHEDULE && J >= 12 && J % 3 == 0) {
+            expand_step_simd<J + 4>(w);
+        }
+#endif
+        // W_{j+4}覆盖窗口中已不再使用的W_{j-12}，它依赖的W_{j-12}~W_{j+1}都还在窗口内
+        if constexpr (S == RING_SCHEDULE && J >= 12) {
+            w[(J + 4) & 15] = expand_word(w[(J - 12) & 15], w[(J - 5) & 15], w[(J + 1) & 15],
+                                          w[(J - 9) & 15], w[(J - 2) & 15]);
+        }
+        // T_j <<< (j mod 32) 在编译期算好，每轮只是一个立即数
+        constexpr uint32_t t_j = left_rotate(J < 16 ? 0x79CC4519 : 0x7A879D8A, J);
+        const uint32_t a12 = left_rotate(a, 12);
+        const uint32_t ss1 = left_rotate(a12 + e + t_j, 7);
+        const uint32_t ss2 = ss1 ^ a12;
+        uint32_t ff, gg;
+        if constexpr (J < 16) {
+            ff = a ^ b ^ c;
+            gg = e ^ f ^ g;
+        } else {
+            ff = (a & b) | (a & c) | (b & c);
+            gg = (e & f) | (~e & g);
+        }
+        constexpr int WINDOW = S == RING_SCHEDULE ? 16 : 68;
+        const uint32_t w_j = w[J % WINDOW];
+        const uint32_t tt1 = ff + d + ss2 + (w_j ^ w[(J + 4) % WINDOW]);   // W'_j = W_j ^ W_{j+4}
+        const uint32_t tt2 = gg + h + ss1 + w_j;
+        b = left_rotate(b, 9);
+        f = left_rotate(f, 19);
+        d = tt1;
+        h = permute0(tt2);
+        round_hook(J);
+    }
+
+    // 模板递归展开第J~63轮；64轮后变量的轮换正好回到原位
+    template <int J, Schedule S, typename Words, typename RoundHook>
+    static inline void rounds(uint32_t& a, uint32_t& b, uint32_t& c, uint32_t& d,
+                              uint32_t& e, uint32_t& f, uint32_t& g, uint32_t& h,
+                              Words* w, RoundHook& round_hook) {
+        if constexpr (J < 64) {
+            round<J, S>(a, b, c, d, e, f, g, h, w, round_hook);
+            rounds<J + 1, S>(d, a, b, c, h, e, f, g, w, round_hook);
+        }
+    }
+
+    static uint32_t load_be32(const uint8_t* p) {
+        return (static_cast<uint32_t>(p[0]) << 24) | (static_cast<uint32_t>(p[1]) << 16) |
+               (static_cast<uint32_t>(p[2]) << 8) | static_cast<uint32_t>(p[3]);
+    }
+
+    // 按大端读入消息分组的16个字
+    static void load_message(const uint8_t* block, uint32_t w[16]) {
+        for (int j = 0; j < 16; ++j) w[j] = load_be32(block + 4 * j);
+    }
+
+    // 消息扩展：W_j = P1(W_{j-16} ^ W_{j-9} ^ (W_{j-3} <<< 15)) ^ (W_{j-13} <<< 7) ^ W_{j-6}
+    static constexpr uint32_t expand_word(uint32_t w16, uint32_t w9, uint32_t w3, uint32_t w13, uint32_t w6) {
+        return permute1(w16 ^ w9 ^ left_rotate(w3, 15)) ^ left_rotate(w13, 7) ^ w6;
+    }
+
+    // 只含填充的分组 0x80 || 0...0 || bit_len 的完整消息扩展（编译期计算）
+    static constexpr std::array<uint32_t, 68> expand_constant_block(uint64_t bit_len) {
+        std::array<uint32_t, 68> w = {};
+        w[0] = 0x80000000;
+        w[14] = static_cast<uint32_t>(bit_len >> 32);
+        w[15] = static_cast<uint32_t>(bit_len);
+        for (int j = 16; j < 68; ++j) {
+            w[j] = expand_word(w[j-16], w[j-9], w[j-3], w[j-13], w[j-6]);
+        }
+        return w;
+    }
+
+#ifdef __SSSE3__
+    // W_0~W_67，向量化扩展每步写4个字（最后一步越过W_67），故多留4个
+    static constexpr int MESSAGE_WORDS = 72;
+
+    static __m128i rotl_epi32(__m128i x, int s) {
+        return _mm_or_si128(_mm_slli_epi32(x, s), _mm_srli_epi32(x, 32 - s));
+    }
+
+    static void load_message_simd(const uint8_t* block, uint32_t w[MESSAGE_WORDS]) {
+        // pshufb把每个字的4个字节倒序，完成大端读入
+        const __m128i bswap = _mm_setr_epi8(3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12);
+        for (int i = 0; i < 4; ++i) {
+            __m128i m = _mm_loadu_si128(reinterpret_cast<const __m128i*>(block + 16 * i));
+            _mm_store_si128(reinterpret_cast<__m128i*>(w + 4 * i), _mm_shuffle_epi8(m, bswap));
+        }
+        w[16] = 0;   // 第一步第4条通道读到的W_16
+    }
+
+    // W_j依赖W_{j-3}，一个向量步只能得到3个有效字：
+    // 用W_{j-16..j-13}、W_{j-13..j-10}、W_{j-9..j-6}、W_{j-6..j-3}、W_{j-3..j}算出W_j~W_{j+2}，
+    // 第4条通道用到尚未算出的W_j，结果无效，由下一步覆盖
+    template <int j>
+    static void expand_step_simd(uint32_t w[MESSAGE_WORDS]) {
+        __m128i w16 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(w + j - 16));
+        __m128i w13 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(w + j - 13));
+        __m128i w9 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(w + j - 9));
+        __m128i w6 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(w + j - 6));
+        __m128i w3 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(w + j - 3));
+        __m128i x = _mm_xor_si128(_mm_xor_si128(w16, w9), rotl_epi32(w3, 15));
+        x = _mm_xor_si128(_mm_xor_si128(x, rotl_epi32(x, 15)), rotl_epi32(x, 23));   // P1
+        x = _mm_xor_si128(_mm_xor_si128(x, rotl_epi32(w13, 7)), w6);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(w + j), x);
+    }
+#endif
+public:
+    // 定长快速路径（hash对32、64字节的输入自动选用）。放在类末尾：编译期扩展填充分组要用到上面的constexpr函数
+    // 32字节消息（如Merkle节点的子摘要）：只有一个分组，后8个字是常量填充 0x80 || 0...0 || 256，
+    // 不构造填充缓冲区；初始值和填充字都是常量，前几轮和相应的消息扩展可在编译期部分折叠
+    static void hash32(const uint8_t data[DIGEST_BYTES], uint8_t out[DIGEST_BYTES]) noexcept {
+        uint32_t w[16];
+        for (int j = 0; j < 8; ++j) w[j] = load_be32(data + 4 * j);
+        w[8] = 0x80000000;
+        for (int j = 9; j < 15; ++j) w[j] = 0;
+        w[15] = DIGEST_BYTES * 8;
+        std::array<uint32_t, 8> state = INITIAL_STATE;
+        auto no_hook = [](int) {};
+        compress<RING_SCHEDULE>(state, w, no_hook);
+        store_digest(state, out);
+    }
+
+    // 64字节消息（如叶子摘要对、两个子节点拼接）：第二个分组全是填充，其W_0~W_67在编译期算好
+    static void hash64(const uint8_t data[BLOCK_BYTES], uint8_t out[DIGEST_BYTES]) noexcept {
+        static constexpr std::array<uint32_t, 68> PADDING_WORDS = expand_constant_block(BLOCK_BYTES * 8);
+        std::array<uint32_t, 8> state = INITIAL_STATE;
+        process_block(state, data);
+        auto no_hook = [](int) {};
+        compress<CONSTANT_SCHEDULE>(state, PADDING_WORDS.data(), no_hook);
+        store_digest(state, out);
+    }
+};
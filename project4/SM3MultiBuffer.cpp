@@ -0,0 +1,73 @@
+#include <iostream>
+#include <vector>
+#include <random>
+#include <chrono>
+#include <algorithm>
+#include "SM3MultiBuffer.h"
+
+// 多缓冲SM3测试：与单路SM3Hash逐条比较，并比较大量32/64字节短消息的吞吐量
+int main() {
+    std::cout << "=== SM3 Multi-Buffer Test (" << SM3MultiBuffer::LANES << " lanes) ===\n";
+
+    // 长度各异的消息：覆盖0、填充跨两个分组、较长消息与短消息混在一起
+    std::mt19937 rng(1);
+    std::vector<std::vector<uint8_t>> messages;
+    for (size_t len : {0, 1, 55, 56, 63, 64, 65, 119, 120, 128, 5000, 100000}) {
+        messages.emplace_back(len);
+    }
+    for (int i = 0; i < 1000; ++i) messages.emplace_back(rng() % (i % 10 == 0 ? 3000 : 300));
+    for (auto& m : messages) {
+        for (uint8_t& x : m) x = static_cast<uint8_t>(rng());
+    }
+
+    std::vector<const uint8_t*> data;
+    std::vector<size_t> lens;
+    for (auto& m : messages) {
+        data.push_back(m.data());
+        lens.push_back(m.size());
+    }
+    std::vector<SM3Hash::Digest> digests(messages.size());
+    SM3MultiBuffer::hash_many(data.data(), lens.data(), messages.size(), digests.data());
+    bool ok = true;
+    for (size_t i = 0; i < messages.size(); ++i) {
+        ok = ok && digests[i] == SM3Hash::hash(messages[i].data(), messages[i].size());
+    }
+    std::cout << "hash_many vs SM3Hash::hash: " << (ok ? "Passed" : "Failed") << "\n";
+
+    // submit/flush：不足一批、恰好一批和多批
+    bool stream_ok = true;
+    for (size_t count : {size_t(1), size_t(3), SM3MultiBuffer::LANES, 3 * SM3MultiBuffer::LANES + 1}) {
+        SM3MultiBuffer mb;
+        std::vector<SM3Hash::Digest> out(count);
+        for (size_t i = 0; i < count; ++i) mb.submit(messages[i].data(), messages[i].size(), out[i].data());
+        mb.flush();
+        for (size_t i = 0; i < count; ++i) {
+            stream_ok = stream_ok && out[i] == SM3Hash::hash(messages[i].data(), messages[i].size());
+        }
+    }
+    std::cout << "submit/flush: " << (stream_ok ? "Passed" : "Failed") << "\n";
+
+    // 吞吐量：100万条定长消息
+    bool bench_ok = true;
+    const size_t count = 1000000;
+    for (size_t len : {32, 64}) {
+        std::vector<uint8_t> pool(count * len);
+        for (size_t i = 0; i < pool.size(); ++i) pool[i] = static_cast<uint8_t>(i * 131 + 7);
+        std::vector<const uint8_t*> ptrs(count);
+        std::vector<size_t> sizes(count, len);
+        for (size_t i = 0; i < count; ++i) ptrs[i] = pool.data() + i * len;
+        std::vector<SM3Hash::Digest> single(count), multi(count);
+
+        auto start = std::chrono::high_resolution_clock::now();
+        for (size_t i = 0; i < count; ++i) SM3Hash::hash(ptrs[i], len, single[i]);
+        auto mid = std::chrono::high_resolution_clock::now();
+        SM3MultiBuffer::hash_many(ptrs.data(), sizes.data(), count, multi.data());
+        auto end = std::chrono::high_resolution_clock::now();
+
+        std::cout << len << "字节消息: 单路 " << count / std::chrono::duration<double>(mid - start).count()
+                  << " 次/秒, 多缓冲 " << count / std::chrono::duration<double>(end - mid).count() << " 次/秒"
+                  << (single == multi ? "" : " (结果不一致)") << "\n";
+        bench_ok = bench_ok && single == multi;
+    }
+    return ok && stream_ok && bench_ok ? 0 : 1;
+}
@@ -0,0 +1,272 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#if defined(__AVX2__) || defined(__AVX512F__)
+#include <immintrin.h>
+#endif
+#include "SM3Hash.h"
+
+// 多缓冲SM3：同时哈希LANES条互不相关的消息，每条消息占一个32位SIMD通道
+// - AVX-512下16路，循环移位用vprold，布尔函数用vpternlogd；AVX2下8路；
+//   都没有时是8路的标量循环（编译器可自动向量化）
+// - 每条通道记录自己剩余的整分组和已填充好的末尾一到两个分组，消息结束即写出摘要、换上下一条消息
+// - flush时只剩少数通道还在工作，就改用单路SM3Hash::process_block做完，不让空转的通道拖慢长消息
+// 适合Merkle叶子、去重索引、口令预处理这类大量独立短消息；单条长消息仍用SM3Hash
+class SM3MultiBuffer {
+public:
+#if defined(__AVX512F__)
+    static constexpr size_t LANES = 16;
+#else
+    static constexpr size_t LANES = 8;
+#endif
+    // flush时工作通道不多于此数就改走单路：约为LANES除以多缓冲相对单路的加速比（AVX2约2.5倍，AVX-512约4倍）
+    static constexpr size_t SCALAR_TAIL_LANES = LANES / 4;
+
+    using Digest = SM3Hash::Digest;
+
+    SM3MultiBuffer() = default;
+    SM3MultiBuffer(const SM3MultiBuffer&) = delete;
+    SM3MultiBuffer& operator=(const SM3MultiBuffer&) = delete;
+
+    // 提交一条消息。通道已满时先推进压缩，直到有消息完成腾出通道；
+    // data在该消息的摘要写入out之前须保持有效（最迟到flush返回）
+    void submit(const uint8_t* data, size_t len, uint8_t out[SM3Hash::DIGEST_BYTES]) noexcept {
+        static const SM3Hash::Midstate initial = { SM3Hash::INITIAL_STATE, 0 };
+        submit(initial, data, len, out);
+    }
+
+    // 提交一条从链接状态prefix继续的消息，摘要为 前缀 || data 的摘要（如HMAC的内外两层）
+    void submit(const SM3Hash::Midstate& prefix, const uint8_t* data, size_t len,
+                uint8_t out[SM3Hash::DIGEST_BYTES]) noexcept {
+        while (active_ == LANES) step();
+        size_t lane = 0;
+        while (lanes_[lane].out) ++lane;
+        Lane& l = lanes_[lane];
+        l.data = data;
+        l.blocks = len / SM3Hash::BLOCK_BYTES;
+        l.out = out;
+        l.tail_pos = 0;
+        l.tail_blocks = pad_tail(data + l.blocks * SM3Hash::BLOCK_BYTES, len % SM3Hash::BLOCK_BYTES,
+                                 prefix.bytes + len, l.tail);
+        for (int i = 0; i < 8; ++i) state_[i][lane] = prefix.state[i];
+        ++active_;
+    }
+
+    // 完成所有已提交的消息
+    void flush() noexcept {
+        while (active_ > SCALAR_TAIL_LANES) step();
+        for (size_t lane = 0; lane < LANES; ++lane) {
+            if (lanes_[lane].out) finish_scalar(lane);
+        }
+    }
+
+    // 一次哈希count条消息，第i条的摘要写入out[i]
+    static void hash_many(const uint8_t* const* data, const size_t* lens, size_t count, Digest* out) noexcept {
+        SM3MultiBuffer mb;
+        for (size_t i = 0; i < count; ++i) mb.submit(data[i], lens[i], out[i].data());
+        mb.flush();
+    }
+
+    // 压缩函数：state[i][lane]为第lane条通道的第i个链接变量，block[lane]为该通道的64字节分组
+    static void process_blocks(uint32_t state[8][LANES], const uint8_t* const block[LANES]) noexcept {
+        alignas(64) uint32_t m[16][LANES];
+        for (size_t lane = 0; lane < LANES; ++lane) {
+            for (int j = 0; j < 16; ++j) {
+                m[j][lane] = load_be32(block[lane] + 4 * j);
+            }
+        }
+        Vec w[16];
+        for (int j = 0; j < 16; ++j) w[j] = load(m[j]);
+        Vec a = load(state[0]), b = load(state[1]), c = load(state[2]), d = load(state[3]);
+        Vec e = load(state[4]), f = load(state[5]), g = load(state[6]), h = load(state[7]);
+
+        rounds<0>(a, b, c, d, e, f, g, h, w);
+
+        store(state[0], vxor(load(state[0]), a)); store(state[1], vxor(load(state[1]), b));
+        store(state[2], vxor(load(state[2]), c)); store(state[3], vxor(load(state[3]), d));
+        store(state[4], vxor(load(state[4]), e)); store(state[5], vxor(load(state[5]), f));
+        store(state[6], vxor(load(state[6]), g)); store(state[7], vxor(load(state[7]), h));
+    }
+
+private:
+    struct Lane {
+        const uint8_t* data = nullptr;              // 下一个整分组
+        size_t blocks = 0;                          // 剩余整分组数
+        uint8_t tail[SM3Hash::BLOCK_BYTES * 2];     // 填充后的末尾分组
+        size_t tail_blocks = 0;
+        size_t tail_pos = 0;
+        uint8_t* out = nullptr;                     // 非空表示通道正在使用
+    };
+
+    alignas(64) uint32_t state_[8][LANES] = {};
+    Lane lanes_[LANES];
+    size_t active_ = 0;
+
+    // 所有通道压缩一个分组；空闲通道压缩全零分组，结果丢弃
+    void step() noexcept {
+        static const uint8_t idle[SM3Hash::BLOCK_BYTES] = {};
+        const uint8_t* block[LANES];
+        for (size_t lane = 0; lane < LANES; ++lane) {
+            const Lane& l = lanes_[lane];
+            if (!l.out) block[lane] = idle;
+            else if (l.blocks > 0) block[lane] = l.data;
+            else block[lane] = l.tail + l.tail_pos * SM3Hash::BLOCK_BYTES;
+        }
+        process_blocks(state_, block);
+        for (size_t lane = 0; lane < LANES; ++lane) {
+            Lane& l = lanes_[lane];
+            if (!l.out) continue;
+            if (l.blocks > 0) {
+                l.data += SM3Hash::BLOCK_BYTES;
+                --l.blocks;
+            } else if (++l.tail_pos == l.tail_blocks) {
+                write_digest(lane);
+            }
+        }
+    }
+
+    // 取出通道的链接变量，用单路压缩函数处理剩余分组
+    void finish_scalar(size_t lane) noexcept {
+        Lane& l = lanes_[lane];
+        std::array<uint32_t, 8> s;
+        for (int i = 0; i < 8; ++i) s[i] = state_[i][lane];
+        for (; l.blocks > 0; --l.blocks, l.data += SM3Hash::BLOCK_BYTES) SM3Hash::process_block(s, l.data);
+        for (; l.tail_pos < l.tail_blocks; ++l.tail_pos) {
+            SM3Hash::process_block(s, l.tail + l.tail_pos * SM3Hash::BLOCK_BYTES);
+        }
+        for (int i = 0; i < 8; ++i) state_[i][lane] = s[i];
+        write_digest(lane);
+    }
+
+    void write_digest(size_t lane) noexcept {
+        Lane& l = lanes_[lane];
+        for (int i = 0; i < 8; ++i) {
+            uint32_t v = state_[i][lane];
+            l.out[4 * i] = static_cast<uint8_t>(v >> 24);
+            l.out[4 * i + 1] = static_cast<uint8_t>(v >> 16);
+            l.out[4 * i + 2] = static_cast<uint8_t>(v >> 8);
+            l.out[4 * i + 3] = static_cast<uint8_t>(v);
+        }
+        l.out = nullptr;
+        --active_;
+    }
+
+    // 尾部 || 0x80 || 0...0 || 64位大端比特长度，返回分组数（1或2）
+    static size_t pad_tail(const uint8_t* tail, size_t tail_len, uint64_t total_bytes,
+                           uint8_t out[SM3Hash::BLOCK_BYTES * 2]) noexcept {
+        memset(out, 0, SM3Hash::BLOCK_BYTES * 2);
+        if (tail_len > 0) memcpy(out, tail, tail_len);
+        out[tail_len] = 0x80;
+        const size_t blocks = tail_len + 1 + 8 > SM3Hash::BLOCK_BYTES ? 2 : 1;
+        const uint64_t bit_len = total_bytes * 8;
+        for (int i = 0; i < 8; ++i) {
+            out[blocks * SM3Hash::BLOCK_BYTES - 1 - i] = static_cast<uint8_t>(bit_len >> (8 * i));
+        }
+        return blocks;
+    }
+
+    static uint32_t load_be32(const uint8_t* p) {
+        return (static_cast<uint32_t>(p[0]) << 24) | (static_cast<uint32_t>(p[1]) << 16) |
+               (static_cast<uint32_t>(p[2]) << 8) | static_cast<uint32_t>(p[3]);
+    }
+
+    // --- 按通道并行的32位字运算 ---
+#if defined(__AVX512F__)
+    using Vec = __m512i;
+    static Vec load(const uint32_t* p) { return _mm512_load_si512(p); }
+    static void store(uint32_t* p, Vec v) { _mm512_store_si512(p, v); }
+    static Vec set1(uint32_t x) { return _mm512_set1_epi32(static_cast<int>(x)); }
+    static Vec vxor(Vec a, Vec b) { return _mm512_xor_si512(a, b); }
+    static Vec vadd(Vec a, Vec b) { return _mm512_add_epi32(a, b); }
+    template <int S>
+    static Vec rotl(Vec x) { return _mm512_maskz_rol_epi32(0xFFFF, x, S); }   // 即vprold；不带掩码的写法在GCC 12下误报未初始化
+    static Vec xor3(Vec a, Vec b, Vec c) { return _mm512_ternarylogic_epi32(a, b, c, 0x96); }
+    static Vec majority(Vec a, Vec b, Vec c) { return _mm512_ternarylogic_epi32(a, b, c, 0xE8); }
+    static Vec choose(Vec e, Vec f, Vec g) { return _mm512_ternarylogic_epi32(e, f, g, 0xCA); }
+#elif defined(__AVX2__)
+    using Vec = __m256i;
+    static Vec load(const uint32_t* p) { return _mm256_load_si256(reinterpret_cast<const __m256i*>(p)); }
+    static void store(uint32_t* p, Vec v) { _mm256_store_si256(reinterpret_cast<__m256i*>(p), v); }
+    static Vec set1(uint32_t x) { return _mm256_set1_epi32(static_cast<int>(x)); }
+    static Vec vxor(Vec a, Vec b) { return _mm256_xor_si256(a, b); }
+    static Vec vadd(Vec a, Vec b) { return _mm256_add_epi32(a, b); }
+    template <int S>
+    static Vec rotl(Vec x) { return _mm256_or_si256(_mm256_slli_epi32(x, S), _mm256_srli_epi32(x, 32 - S)); }
+    static Vec xor3(Vec a, Vec b, Vec c) { return _mm256_xor_si256(_mm256_xor_si256(a, b), c); }
+    static Vec majority(Vec a, Vec b, Vec c) {
+        return _mm256_or_si256(_mm256_and_si256(a, b), _mm256_and_si256(c, _mm256_or_si256(a, b)));
+    }
+    static Vec choose(Vec e, Vec f, Vec g) {
+        return _mm256_or_si256(_mm256_and_si256(e, f), _mm256_andnot_si256(e, g));
+    }
+#else
+    struct Vec {
+        uint32_t v[LANES];
+    };
+    static Vec load(const uint32_t* p) { Vec r; memcpy(r.v, p, sizeof(r.v)); return r; }
+    static void store(uint32_t* p, const Vec& x) { memcpy(p, x.v, sizeof(x.v)); }
+    static Vec set1(uint32_t x) { Vec r; for (size_t i = 0; i < LANES; ++i) r.v[i] = x; return r; }
+    static Vec vxor(const Vec& a, const Vec& b) {
+        Vec r; for (size_t i = 0; i < LANES; ++i) r.v[i] = a.v[i] ^ b.v[i]; return r;
+    }
+    static Vec vadd(const Vec& a, const Vec& b) {
+        Vec r; for (size_t i = 0; i < LANES; ++i) r.v[i] = a.v[i] + b.v[i]; return r;
+    }
+    template <int S>
+    static Vec rotl(const Vec& x) {
+        Vec r; for (size_t i = 0; i < LANES; ++i) r.v[i] = (x.v[i] << S) | (x.v[i] >> (32 - S)); return r;
+    }
+    static Vec xor3(const Vec& a, const Vec& b, const Vec& c) {
+        Vec r; for (size_t i = 0; i < LANES; ++i) r.v[i] = a.v[i] ^ b.v[i] ^ c.v[i]; return r;
+    }
+    static Vec majority(const Vec& a, const Vec& b, const Vec& c) {
+        Vec r; for (size_t i = 0; i < LANES; ++i) r.v[i] = (a.v[i] & b.v[i]) | (c.v[i] & (a.v[i] | b.v[i])); return r;
+    }
+    static Vec choose(const Vec& e, const Vec& f, const Vec& g) {
+        Vec r; for (size_t i = 0; i < LANES; ++i) r.v[i] = (e.v[i] & f.v[i]) | (~e.v[i] & g.v[i]); return r;
+    }
+#endif
+
+    static Vec permute0(Vec x) { return xor3(x, rotl<9>(x), rotl<17>(x)); }
+    static Vec permute1(Vec x) { return xor3(x, rotl<15>(x), rotl<23>(x)); }
+
+    // 与SM3Hash::round相同的展开方式：变量按(d, a, b, c, h, e, f, g)轮换，消息字用16字滑动窗口
+    template <int J>
+    static inline void round(Vec a, Vec& b, Vec c, Vec& d, Vec e, Vec& f, Vec g, Vec& h, Vec* w) {
+        if constexpr (J >= 12) {
+            w[(J + 4) & 15] = xor3(permute1(xor3(w[(J - 12) & 15], w[(J - 5) & 15], rotl<15>(w[(J + 1) & 15]))),
+                                   rotl<7>(w[(J - 9) & 15]), w[(J - 2) & 15]);
+        }
+        constexpr uint32_t t = J < 16 ? 0x79CC4519 : 0x7A879D8A;
+        constexpr uint32_t t_j = J % 32 == 0 ? t : (t << (J % 32)) | (t >> (32 - J % 32));
+        const Vec a12 = rotl<12>(a);
+        const Vec ss1 = rotl<7>(vadd(vadd(a12, e), set1(t_j)));
+        const Vec ss2 = vxor(ss1, a12);
+        Vec ff, gg;
+        if constexpr (J < 16) {
+            ff = xor3(a, b, c);
+            gg = xor3(e, f, g);
+        } else {
+            ff = majority(a, b, c);
+            gg = choose(e, f, g);
+        }
+        const Vec w_j = w[J & 15];
+        const Vec tt1 = vadd(vadd(ff, d), vadd(ss2, vxor(w_j, w[(J + 4) & 15])));
+        const Vec tt2 = vadd(vadd(gg, h), vadd(ss1, w_j));
+        b = rotl<9>(b);
+        f = rotl<19>(f);
+        d = tt1;
+        h = permute0(tt2);
+    }
+
+    template <int J>
+    static inline void rounds(Vec& a, Vec& b, Vec& c, Vec& d, Vec& e, Vec& f, Vec& g, Vec& h, Vec* w) {
+        if constexpr (J < 64) {
+            round<J>(a, b, c, d, e, f, g, h, w);
+            rounds<J + 1>(d, a, b, c, h, e, f, g, w);
+        }
+    }
+};
@@ -0,0 +1,425 @@
+// sm3sum：并行计算文件和目录树的SM3摘要，输出格式与sha256sum相同，-c校验摘要列表
+//   sm3sum [-j 线程数] [-r] 路径...        目录递归遍历（-r可省略），"-"表示标准输入
+//   sm3sum -c [--quiet] 列表文件...         校验 "摘要  路径" 形式的列表
+// 文件按输入顺序分批：一批内各线程从原子计数器领取文件，结果按原顺序输出，内存占用与文件总数无关。
+// 大文件用mmap + MADV_SEQUENTIAL映射后直接哈希；小文件读入线程本地缓冲区，凑满一组后走多缓冲SM3通道
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+#if defined(__unix__) || defined(__APPLE__)
+#include <csetjmp>
+#include <csignal>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define SM3SUM_POSIX 1
+#endif
+#include "SM3Hash.h"
+#include "SM3MultiBuffer.h"
+
+namespace fs = std::filesystem;
+
+constexpr size_t SMALL_FILE_BYTES = 16 << 10;                        // 不超过此大小的文件走多缓冲通道
+constexpr size_t SMALL_BATCH_FILES = SM3MultiBuffer::LANES * 8;      // 每个线程攒够这么多小文件再一起哈希
+constexpr size_t BATCH_FILES = 16384;                                // 每批处理、输出的文件数
+constexpr size_t READ_BYTES = 1 << 20;                               // 标准输入与非POSIX平台的读缓冲区
+
+struct Job {
+    std::string path;
+    std::string expected;   // 校验模式下列表中的摘要（十六进制）
+    SM3Hash::Digest digest;
+    std::string error;      // 非空表示打开或读取失败
+};
+
+std::string to_hex(const SM3Hash::Digest& d) {
+    static const char digits[] = "0123456789abcdef";
+    std::string s(2 * d.size(), '0');
+    for (size_t i = 0; i < d.size(); ++i) {
+        s[2 * i] = digits[d[i] >> 4];
+        s[2 * i + 1] = digits[d[i] & 15];
+    }
+    return s;
+}
+
+// 流式哈希（标准输入、非POSIX平台）
+bool hash_stream(std::istream& in, SM3Hash::Digest& out) {
+    std::vector<char> buffer(READ_BYTES);
+    SM3Hash ctx;
+    while (in) {
+        in.read(buffer.data(), buffer.size());
+        ctx.update(reinterpret_cast<const uint8_t*>(buffer.data()), static_cast<size_t>(in.gcount()));
+    }
+    if (in.bad()) return false;
+    ctx.final(out);
+    return true;
+}
+
+#ifdef SM3SUM_POSIX
+// 映射的文件在哈希过程中被其他进程截断时，访问文件末尾之后的页会触发SIGBUS。
+// 线程哈希映射区期间登记跳转点和映射范围，处理函数只对落在该范围内的故障跳回，其他SIGBUS照常终止进程
+thread_local sigjmp_buf* bus_jump = nullptr;
+thread_local const uint8_t* bus_begin = nullptr;
+thread_local const uint8_t* bus_end = nullptr;
+
+extern "C" void on_sigbus(int sig, siginfo_t* info, void*) {
+    const uint8_t* addr = static_cast<const uint8_t*>(info->si_addr);
+    if (bus_jump && addr >= bus_begin && addr < bus_end) siglongjmp(*bus_jump, 1);
+    signal(sig, SIG_DFL);
+    raise(sig);
+}
+
+void install_sigbus_handler() {
+    struct sigaction sa;
+    memset(&sa, 0, sizeof(sa));
+    sa.sa_sigaction = on_sigbus;
+    sa.sa_flags = SA_SIGINFO;
+    sigemptyset(&sa.sa_mask);
+    sigaction(SIGBUS, &sa, nullptr);
+}
+
+// 哈希映射区；期间文件被截断返回false
+bool hash_mapped(const uint8_t* p, size_t size, SM3Hash::Digest& out) {
+    sigjmp_buf jump;
+    if (sigsetjmp(jump, 1) != 0) {   // 恢复信号掩码，处理函数里被屏蔽的SIGBUS重新生效
+        bus_jump = nullptr;
+        return false;
+    }
+    bus_begin = p;
+    bus_end = p + size;
+    bus_jump = &jump;
+    std::atomic_signal_fence(std::memory_order_seq_cst);
+    SM3Hash::hash(p, size, out);
+    std::atomic_signal_fence(std::memory_order_seq_cst);
+    bus_jump = nullptr;
+    return true;
+}
+#endif
+
+// 每个工作线程一份：攒小文件的缓冲区和多缓冲引擎
+class Worker {
+public:
+    void hash(Job& job) {
+        if (job.path == "-") {
+            if (!hash_stream(std::cin, job.digest)) job.error = "read error";
+            return;
+        }
+#ifdef SM3SUM_POSIX
+        int fd = open(job.path.c_str(), O_RDONLY | O_CLOEXEC);
+        if (fd < 0) {
+            job.error = strerror(errno);
+            return;
+        }
+        struct stat st;
+        if (fstat(fd, &st) != 0 || !S_ISREG(st.st_mode)) {
+            // 管道、设备等按流读取
+            close(fd);
+            std::ifstream in(job.path, std::ios::binary);
+            if (!in || !hash_stream(in, job.digest)) job.error = "read error";
+            return;
+        }
+        size_t size = static_cast<size_t>(st.st_size);
+        if (size <= SMALL_FILE_BYTES) {
+            read_small(fd, size, job);
+            close(fd);
+            return;
+        }
+        void* p = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+        close(fd);
+        if (p == MAP_FAILED) {
+            job.error = strerror(errno);
+            return;
+        }
+        madvise(p, size, MADV_SEQUENTIAL);
+        if (!hash_mapped(static_cast<const uint8_t*>(p), size, job.digest)) job.error = "file truncated while reading";
+        munmap(p, size);
+#else
+        std::ifstream in(job.path, std::ios::binary);
+        if (!in) {
+            job.error = "cannot open";
+            return;
+        }
+        if (!hash_stream(in, job.digest)) job.error = "read error";
+#endif
+    }
+
+    // 哈希攒下的小文件
+    void flush() {
+        if (small_.empty()) return;
+        for (const Small& s : small_) mb_.submit(buffer_.data() + s.offset, s.size, s.job->digest.data());
+        mb_.flush();
+        small_.clear();
+        buffer_.clear();
+    }
+
+private:
+    struct Small {
+        Job* job;
+        size_t offset;
+        size_t size;
+    };
+
+    SM3MultiBuffer mb_;
+    std::vector<uint8_t> buffer_;
+    std::vector<Small> small_;
+
+#ifdef SM3SUM_POSIX
+    void read_small(int fd, size_t size, Job& job) {
+        size_t offset = buffer_.size();
+        buffer_.resize(offset + size);
+        size_t done = 0;
+        while (done < size) {
+            ssize_t n = read(fd, buffer_.data() + offset + done, size - done);
+            if (n < 0 && errno == EINTR) continue;
+            if (n <= 0) break;
+            done += static_cast<size_t>(n);
+        }
+        if (done < size) {
+            // 读取期间文件被截断，按实际读到的内容计算
+            buffer_.resize(offset + done);
+        }
+        small_.push_back({ &job, offset, done });
+        if (small_.size() == SMALL_BATCH_FILES) flush();
+    }
+#endif
+};
+
+// 并行处理一批文件，各线程从计数器领取下一个文件
+void hash_batch(std::vector<Job>& jobs, unsigned threads) {
+    std::atomic<size_t> next{0};
+    auto work = [&] {
+        Worker worker;
+        for (size_t i; (i = next.fetch_add(1, std::memory_order_relaxed)) < jobs.size();) {
+            worker.hash(jobs[i]);
+        }
+        worker.flush();
+    };
+    // 标准输入只能在一个线程里读
+    bool has_stdin = std::any_of(jobs.begin(), jobs.end(), [](const Job& j) { return j.path == "-"; });
+    if (threads <= 1 || jobs.size() <= 1 || has_stdin) {
+        work();
+        return;
+    }
+    std::vector<std::thread> pool;
+    for (unsigned t = 1; t < threads; ++t) pool.emplace_back(work);
+    work();
+    for (std::thread& t : pool) t.join();
+}
+
+// 与sha256sum（coreutils 9.1起）相同：路径含反斜杠、换行或回车时整行以反斜杠开头，
+// 路径中的这三个字符分别写成 \\ \n \r
+std::string escape_path(const std::string& path, bool& escaped) {
+    escaped = path.find_first_of("\\\n\r") != std::string::npos;
+    if (!escaped) return path;
+    std::string s;
+    for (char c : path) {
+        if (c == '\\') s += "\\\\";
+        else if (c == '\n') s += "\\n";
+        else if (c == '\r') s += "\\r";
+        else s += c;
+    }
+    return s;
+}
+
+// escape_path的逆变换；出现其他转义或末尾孤立的反斜杠时返回false（该行格式错误）
+bool unescape_path(const std::string& path, std::string& out) {
+    out.clear();
+    for (size_t i = 0; i < path.size(); ++i) {
+        if (path[i] != '\\') {
+            out += path[i];
+            continue;
+        }
+        if (++i == path.size()) return false;
+        switch (path[i]) {
+        case '\\': out += '\\'; break;
+        case 'n': out += '\n'; break;
+        case 'r': out += '\r'; break;
+        default: return false;
+        }
+    }
+    return true;
+}
+
+struct Options {
+    unsigned threads = std::max(1u, std::thread::hardware_concurrency());
+    bool check = false;
+    bool quiet = false;
+    std::vector<std::string> paths;
+};
+
+// 深度优先遍历目录：每层按名称排序，输出顺序稳定；只保存当前路径上各层的目录项，
+// 内存与树中的文件总数无关。不跟随指向目录的符号链接
+template <typename Add>
+void walk(const fs::path& dir, Add& add, int& status) {
+    std::error_code ec;
+    std::vector<fs::directory_entry> entries;
+    for (fs::directory_iterator it(dir, fs::directory_options::skip_permission_denied, ec), end; !ec && it != end;
+         it.increment(ec)) {
+        entries.push_back(*it);
+    }
+    if (ec) {
+        std::cerr << "sm3sum: " << dir.string() << ": " << ec.message() << "\n";
+        status = 1;
+    }
+    std::sort(entries.begin(), entries.end(),
+              [](const fs::directory_entry& a, const fs::directory_entry& b) { return a.path() < b.path(); });
+    for (const fs::directory_entry& e : entries) {
+        if (e.is_directory(ec) && !e.is_symlink(ec)) walk(e.path(), add, status);
+        else if (e.is_regular_file(ec)) add(e.path().string());
+    }
+}
+
+// --- 计算模式 ---
+int run_hash(const Options& opt) {
+    int status = 0;
+    std::vector<Job> batch;
+    auto emit = [&] {
+        hash_batch(batch, opt.threads);
+        for (const Job& job : batch) {
+            if (!job.error.empty()) {
+                std::cerr << "sm3sum: " << job.path << ": " << job.error << "\n";
+                status = 1;
+                continue;
+            }
+            bool escaped;
+            std::string name = escape_path(job.path, escaped);
+            std::cout << (escaped ? "\\" : "") << to_hex(job.digest) << "  " << name << "\n";
+        }
+        batch.clear();
+    };
+    auto add = [&](const std::string& path) {
+        batch.push_back({ path, {}, {}, {} });
+        if (batch.size() == BATCH_FILES) emit();
+    };
+
+    for (const std::string& path : opt.paths) {
+        std::error_code ec;
+        if (path != "-" && fs::is_directory(path, ec)) {
+            walk(path, add, status);
+        } else {
+            add(path);
+        }
+    }
+    emit();
+    return status;
+}
+
+// --- 校验模式 ---
+int run_check(const Options& opt) {
+    size_t mismatched = 0, unreadable = 0, malformed = 0;
+    std::vector<Job> batch;
+    auto emit = [&] {
+        hash_batch(batch, opt.threads);
+        for (const Job& job : batch) {
+            bool escaped;
+            std::string name = escape_path(job.path, escaped);
+            const char* prefix = escaped ? "\\" : "";
+            if (!job.error.empty()) {
+                std::cerr << "sm3sum: " << job.path << ": " << job.error << "\n";
+                std::cout << prefix << name << ": FAILED open or read\n";
+                ++unreadable;
+            } else if (to_hex(job.digest) != job.expected) {
+                std::cout << prefix << name << ": FAILED\n";
+                ++mismatched;
+            } else if (!opt.quiet) {
+                std::cout << prefix << name << ": OK\n";
+            }
+        }
+        batch.clear();
+    };
+
+    std::vector<std::string> lists = opt.paths;
+    if (lists.empty()) lists.push_back("-");
+    for (const std::string& list : lists) {
+        std::ifstream file;
+        if (list != "-") {
+            file.open(list);
+            if (!file) {
+                std::cerr << "sm3sum: " << list << ": cannot open\n";
+                return 1;
+            }
+        }
+        std::istream& in = list == "-" ? std::cin : file;
+        std::string line;
+        while (std::getline(in, line)) {
+            // 列表被转换成CRLF换行时去掉行尾回车；路径中的回车已转义为\r，不受影响
+            if (!line.empty() && line.back() == '\r') line.pop_back();
+            bool escaped = !line.empty() && line[0] == '\\';
+            std::string rest = escaped ? line.substr(1) : line;
+            // "摘要  路径"（文本模式）或 "摘要 *路径"（二进制模式）
+            if (rest.size() < 2 * SM3Hash::DIGEST_BYTES + 3 || rest[2 * SM3Hash::DIGEST_BYTES] != ' ' ||
+                (rest[2 * SM3Hash::DIGEST_BYTES + 1] != ' ' && rest[2 * SM3Hash::DIGEST_BYTES + 1] != '*')) {
+                ++malformed;
+                continue;
+            }
+            std::string hex = rest.substr(0, 2 * SM3Hash::DIGEST_BYTES);
+            std::transform(hex.begin(), hex.end(), hex.begin(), [](unsigned char c) { return std::tolower(c); });
+            if (hex.find_first_not_of("0123456789abcdef") != std::string::npos) {
+                ++malformed;
+                continue;
+            }
+            std::string path = rest.substr(2 * SM3Hash::DIGEST_BYTES + 2);
+            if (escaped) {
+                std::string raw;
+                if (!unescape_path(path, raw)) {
+                    ++malformed;
+                    continue;
+                }
+                path = raw;
+            }
+            batch.push_back({ path, hex, {}, {} });
+            if (batch.size() == BATCH_FILES) emit();
+        }
+    }
+    emit();
+
+    if (malformed) std::cerr << "sm3sum: WARNING: " << malformed << " line(s) improperly formatted\n";
+    if (unreadable) std::cerr << "sm3sum: WARNING: " << unreadable << " listed file(s) could not be read\n";
+    if (mismatched) std::cerr << "sm3sum: WARNING: " << mismatched << " computed checksum(s) did NOT match\n";
+    return mismatched || unreadable || malformed ? 1 : 0;
+}
+
+void usage() {
+    std::cerr << "用法: sm3sum [-j 线程数] [-r] 文件或目录...\n"
+              << "      sm3sum -c [--quiet] [-j 线程数] 摘要列表...\n"
+              << "输出格式与sha256sum相同；\"-\"表示标准输入\n";
+}
+
+int main(int argc, char* argv[]) {
+    std::ios::sync_with_stdio(false);
+    Options opt;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "-c" || arg == "--check") {
+            opt.check = true;
+        } else if (arg == "--quiet") {
+            opt.quiet = true;
+        } else if (arg == "-r" || arg == "--recursive") {
+            // 目录总是递归遍历，保留此选项便于与其他工具的习惯一致
+        } else if ((arg == "-j" || arg == "--jobs") && i + 1 < argc) {
+            opt.threads = static_cast<unsigned>(std::max(1, atoi(argv[++i])));
+        } else if (arg == "-h" || arg == "--help") {
+            usage();
+            return 0;
+        } else if (arg.size() > 1 && arg[0] == '-' && arg != "-") {
+            usage();
+            return 2;
+        } else {
+            opt.paths.push_back(arg);
+        }
+    }
+    if (!opt.check && opt.paths.empty()) opt.paths.push_back("-");
+#ifdef SM3SUM_POSIX
+    install_sigbus_handler();
+#endif
+    return opt.check ? run_check(opt) : run_hash(opt);
+}
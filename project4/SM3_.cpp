@@ -4,155 +4,9 @@
 #include <iomanip>
 #include <sstream>
 #include <array>
-
-// SM3密码杂凑算法实现类
-class SM3Hash {
-public:
-    // 计算字符串的哈希值
-    std::vector<uint8_t> compute(const std::string& text) {
-        return compute(reinterpret_cast<const uint8_t*>(text.c_str()), text.length());
-    }
-
-    // 计算字节数组的哈希值
-    std::vector<uint8_t> compute(const uint8_t* data, size_t len) {
-        // 初始化哈希缓冲区
-        std::array<uint32_t, 8> buffer = {
-            0x7380166F, 0x4914B2B9, 0x172442D7, 0xDA8A0600,
-            0xA96F30BC, 0x163138AA, 0xE38DEE4D, 0xB0FB0E4E
-        };
-
-        // 对输入数据进行填充处理
-        auto padded_data = add_padding(data, len);
-
-        // 按512位(64字节)分组处理
-        for (size_t i = 0; i < padded_data.size(); i += BLOCK_BYTES) {
-            process_block(buffer, &padded_data[i]);
-        }
-
-        // 将缓冲区数据转换为字节序列
-        std::vector<uint8_t> result(DIGEST_BYTES);
-        for (size_t i = 0; i < buffer.size(); ++i) {
-            result[i*4]   = static_cast<uint8_t>(buffer[i] >> 24);
-            result[i*4+1] = static_cast<uint8_t>(buffer[i] >> 16);
-            result[i*4+2] = static_cast<uint8_t>(buffer[i] >> 8);
-            result[i*4+3] = static_cast<uint8_t>(buffer[i]);
-        }
-
-        return result;
-    }
-
-private:
-    static constexpr size_t BLOCK_BYTES = 64;   // 分组大小(字节)
-    static constexpr size_t DIGEST_BYTES = 32;  // 哈希结果长度(字节)
-
-    // 循环左移操作
-    static uint32_t left_rotate(uint32_t value, uint32_t shift) {
-        return (value << shift) | (value >> (32 - shift));
-    }
-
-    // 置换函数P0
-    static uint32_t permute0(uint32_t x) {
-        return x ^ left_rotate(x, 9) ^ left_rotate(x, 17);
-    }
-
-    // 置换函数P1
-    static uint32_t permute1(uint32_t x) {
-        return x ^ left_rotate(x, 15) ^ left_rotate(x, 23);
-    }
-
-    // 常量Tj生成
-    static constexpr uint32_t get_constant(int j) {
-        return j < 16 ? 0x79CC4519 : 0x7A879D8A;
-    }
-
-    // 布尔函数FF
-    static uint32_t bool_func_ff(uint32_t x, uint32_t y, uint32_t z, int j) {
-        return j < 16 ? x ^ y ^ z : (x & y) | (x & z) | (y & z);
-    }
-
-    // 布尔函数GG
-    static uint32_t bool_func_gg(uint32_t x, uint32_t y, uint32_t z, int j) {
-        return j < 16 ? x ^ y ^ z : (x & y) | ((~x) & z);
-    }
-
-    // 数据填充处理
-    std::vector<uint8_t> add_padding(const uint8_t* data, size_t len) const {
-        const size_t bit_len = len * 8;
-        std::vector<uint8_t> padded(data, data + len);
-
-        // 添加结束标志位'1'
-        padded.push_back(0x80);
-
-        // 填充0直到满足长度要求
-        while ((padded.size() * 8 + 64) % 512 != 0) {
-            padded.push_back(0x00);
-        }
-
-        // 添加原始数据长度(64位大端格式)
-        for (int i = 7; i >= 0; --i) {
-            padded.push_back(static_cast<uint8_t>(bit_len >> (8 * i)));
-        }
-
-        return padded;
-    }
-
-    // 消息扩展
-    void expand_message(const uint8_t* block, std::array<uint32_t, 68>& w,
-                       std::array<uint32_t, 64>& w_prime) const {
-        // 前16个字直接从消息块转换
-        for (int j = 0; j < 16; ++j) {
-            w[j] = (static_cast<uint32_t>(block[j*4]) << 24) |
-                   (static_cast<uint32_t>(block[j*4+1]) << 16) |
-                   (static_cast<uint32_t>(block[j*4+2]) << 8) |
-                   static_cast<uint32_t>(block[j*4+3]);
-        }
-
-        // 生成剩余的W值
-        for (int j = 16; j < 68; ++j) {
-            w[j] = permute1(w[j-16] ^ w[j-9] ^ left_rotate(w[j-3], 15)) ^
-                   left_rotate(w[j-13], 7) ^ w[j-6];
-        }
-
-        // 生成W'序列
-        for (int j = 0; j < 64; ++j) {
-            w_prime[j] = w[j] ^ w[j+4];
-        }
-    }
-
-    // 压缩函数
-    void process_block(std::array<uint32_t, 8>& buffer, const uint8_t* block) const {
-        std::array<uint32_t, 68> w;
-        std::array<uint32_t, 64> w_prime;
-        expand_message(block, w, w_prime);
-
-        // 初始化压缩变量
-        uint32_t a = buffer[0], b = buffer[1], c = buffer[2], d = buffer[3];
-        uint32_t e = buffer[4], f = buffer[5], g = buffer[6], h = buffer[7];
-
-        // 64轮压缩迭代
-        for (int j = 0; j < 64; ++j) {
-            const uint32_t t_j = left_rotate(get_constant(j), j);
-            const uint32_t ss1 = left_rotate(((left_rotate(a, 12) + e + t_j) & 0xFFFFFFFF), 7);
-            const uint32_t ss2 = ss1 ^ left_rotate(a, 12);
-            const uint32_t tt1 = (bool_func_ff(a, b, c, j) + d + ss2 + w_prime[j]) & 0xFFFFFFFF;
-            const uint32_t tt2 = (bool_func_gg(e, f, g, j) + h + ss1 + w[j]) & 0xFFFFFFFF;
-
-            // 更新压缩变量
-            d = c;
-            c = left_rotate(b, 9);
-            b = a;
-            a = tt1;
-            h = g;
-            g = left_rotate(f, 19);
-            f = e;
-            e = permute0(tt2);
-        }
-
-        // 更新缓冲区
-        buffer[0] ^= a; buffer[1] ^= b; buffer[2] ^= c; buffer[3] ^= d;
-        buffer[4] ^= e; buffer[5] ^= f; buffer[6] ^= g; buffer[7] ^= h;
-    }
-};
+#include <algorithm>
+#include <chrono>
+#include "SM3Hash.h"
 
 // 字节数组转十六进制字符串
 std::string to_hex_string(const std::vector<uint8_t>& bytes) {
@@ -164,6 +18,45 @@ std::string to_hex_string(const std::vector<uint8_t>& bytes) {
     return oss.str();
 }
 
+// 按标准逐字实现的SM3（完整W[68]/W'[64]），用来核对SM3Hash在当前编译选项下所走的消息扩展路径
+std::vector<uint8_t> reference_sm3(const uint8_t* data, size_t len) {
+    auto rotl = [](uint32_t x, int n) { n &= 31; return n ? (x << n) | (x >> (32 - n)) : x; };
+    auto p0 = [&](uint32_t x) { return x ^ rotl(x, 9) ^ rotl(x, 17); };
+    auto p1 = [&](uint32_t x) { return x ^ rotl(x, 15) ^ rotl(x, 23); };
+    std::vector<uint8_t> m(data, data + len);
+    m.push_back(0x80);
+    while (m.size() % 64 != 56) m.push_back(0);
+    for (int i = 7; i >= 0; --i) m.push_back(static_cast<uint8_t>((uint64_t(len) * 8) >> (8 * i)));
+    uint32_t v[8] = { 0x7380166f, 0x4914b2b9, 0x172442d7, 0xda8a0600, 0xa96f30bc, 0x163138aa, 0xe38dee4d, 0xb0fb0e4e };
+    for (size_t off = 0; off < m.size(); off += 64) {
+        uint32_t w[68], w1[64];
+        for (int j = 0; j < 16; ++j) {
+            w[j] = uint32_t(m[off + 4 * j]) << 24 | uint32_t(m[off + 4 * j + 1]) << 16 |
+                   uint32_t(m[off + 4 * j + 2]) << 8 | m[off + 4 * j + 3];
+        }
+        for (int j = 16; j < 68; ++j) w[j] = p1(w[j - 16] ^ w[j - 9] ^ rotl(w[j - 3], 15)) ^ rotl(w[j - 13], 7) ^ w[j - 6];
+        for (int j = 0; j < 64; ++j) w1[j] = w[j] ^ w[j + 4];
+        uint32_t a = v[0], b = v[1], c = v[2], d = v[3], e = v[4], f = v[5], g = v[6], h = v[7];
+        for (int j = 0; j < 64; ++j) {
+            uint32_t t = j < 16 ? 0x79cc4519 : 0x7a879d8a;
+            uint32_t ss1 = rotl(rotl(a, 12) + e + rotl(t, j), 7);
+            uint32_t ss2 = ss1 ^ rotl(a, 12);
+            uint32_t ff = j < 16 ? a ^ b ^ c : (a & b) | (a & c) | (b & c);
+            uint32_t gg = j < 16 ? e ^ f ^ g : (e & f) | (~e & g);
+            uint32_t tt1 = ff + d + ss2 + w1[j];
+            uint32_t tt2 = gg + h + ss1 + w[j];
+            d = c; c = rotl(b, 9); b = a; a = tt1;
+            h = g; g = rotl(f, 19); f = e; e = p0(tt2);
+        }
+        v[0] ^= a; v[1] ^= b; v[2] ^= c; v[3] ^= d; v[4] ^= e; v[5] ^= f; v[6] ^= g; v[7] ^= h;
+    }
+    std::vector<uint8_t> out;
+    for (uint32_t x : v) {
+        for (int i = 3; i >= 0; --i) out.push_back(static_cast<uint8_t>(x >> (8 * i)));
+    }
+    return out;
+}
+
 int main() {
     SM3Hash sm3;
 
@@ -186,6 +79,125 @@ int main() {
                   << "匹配: " << (hex_result == expected) << "\n\n";
     }
 
+#ifdef __SSSE3__
+    const char* schedule = "SSE";
+#else
+    const char* schedule = "标量滑动窗口";
+#endif
+    // 与逐字实现的标准算法对照：覆盖0到4个分组之间各种长度
+    std::vector<uint8_t> random_message(300);
+    uint32_t seed = 12345;
+    for (uint8_t& b : random_message) b = static_cast<uint8_t>((seed = seed * 1103515245 + 12345) >> 16);
+    bool reference_ok = true;
+    for (size_t len = 0; len <= random_message.size(); ++len) {
+        reference_ok = reference_ok && sm3.compute(random_message.data(), len) == reference_sm3(random_message.data(), len);
+    }
+    std::cout << "消息扩展(" << schedule << ")与标准实现对照: " << (reference_ok ? "Passed" : "Failed") << "\n";
+
+    // 增量计算：任意切分输入，结果与一次性计算相同
+    std::vector<uint8_t> message(1000);
+    for (size_t i = 0; i < message.size(); ++i) message[i] = static_cast<uint8_t>(i * 31 + 7);
+    bool streaming_ok = true;
+    for (size_t len : {0, 1, 32, 55, 56, 63, 64, 65, 119, 120, 128, 1000}) {
+        auto expected = sm3.compute(message.data(), len);
+        for (size_t step : {1, 3, 64, 100}) {
+            SM3Hash ctx;
+            for (size_t off = 0; off < len; off += step) {
+                ctx.update(message.data() + off, std::min(step, len - off));
+            }
+            streaming_ok = streaming_ok && ctx.final() == expected;
+        }
+    }
+    SM3Hash ctx;
+    ctx.update("ab");
+    ctx.update("c");
+    streaming_ok = streaming_ok && to_hex_string(ctx.final()) == test_cases[0].second;
+    std::cout << "增量计算(init/update/final): " << (streaming_ok ? "Passed" : "Failed") << "\n";
+
+    // 一次性定长接口：结果与compute相同，不分配内存
+    bool fixed_ok = true;
+    for (size_t len : {0, 1, 32, 55, 56, 64, 65, 1000}) {
+        SM3Hash::Digest digest = SM3Hash::hash(message.data(), len);
+        auto expected = sm3.compute(message.data(), len);
+        fixed_ok = fixed_ok && std::equal(digest.begin(), digest.end(), expected.begin());
+    }
+    std::cout << "定长接口(std::array<uint8_t, 32>): " << (fixed_ok ? "Passed" : "Failed") << "\n";
+
+    // 32字节Merkle叶子的吞吐量：std::vector结果与std::array结果
+    const int rounds = 1000000;
+    std::array<uint8_t, 32> leaf = {};
+    auto start = std::chrono::high_resolution_clock::now();
+    for (int i = 0; i < rounds; ++i) {
+        leaf[0] = static_cast<uint8_t>(i);
+        auto digest = sm3.compute(leaf.data(), leaf.size());
+        leaf[1] ^= digest[0];
+    }
+    auto mid = std::chrono::high_resolution_clock::now();
+    for (int i = 0; i < rounds; ++i) {
+        leaf[0] = static_cast<uint8_t>(i);
+        SM3Hash::Digest digest;
+        SM3Hash::hash(leaf.data(), leaf.size(), digest);
+        leaf[1] ^= digest[0];
+    }
+    auto end = std::chrono::high_resolution_clock::now();
+    std::cout << "32字节消息: compute " << rounds / std::chrono::duration<double>(mid - start).count()
+              << " 次/秒, hash " << rounds / std::chrono::duration<double>(end - mid).count() << " 次/秒\n";
+
+
+    // 链接状态：前缀只压缩一次，各条消息从导出的状态继续
+    bool midstate_ok = true;
+    SM3Hash prefix_ctx;
+    prefix_ctx.update(message.data(), 128);
+    SM3Hash::Midstate prefix = {};
+    midstate_ok = midstate_ok && prefix_ctx.export_midstate(prefix) && prefix.bytes == 128;
+    for (size_t len : {0, 1, 32, 64, 100, 872}) {
+        auto expected = sm3.compute(message.data(), 128 + len);
+        SM3Hash resumed(prefix);
+        resumed.update(message.data() + 128, len);
+        SM3Hash::Digest digest;
+        SM3Hash::hash(prefix, message.data() + 128, len, digest.data());
+        midstate_ok = midstate_ok && resumed.final() == expected && std::equal(digest.begin(), digest.end(), expected.begin());
+    }
+    prefix_ctx.update(message.data(), 1);
+    midstate_ok = midstate_ok && !prefix_ctx.export_midstate(prefix);   // 有未压缩的尾部时不能导出
+
+    // 长度扩展：只知道SM3(m)和m的长度，就能算出SM3(m || 填充 || 后缀)
+    const size_t secret_len = 100, padded = 128;
+    SM3Hash::Digest secret_digest = SM3Hash::hash(message.data(), secret_len);
+    std::vector<uint8_t> forged(message.begin(), message.begin() + secret_len);
+    forged.push_back(0x80);
+    forged.resize(padded - 8, 0);
+    for (int i = 7; i >= 0; --i) forged.push_back(static_cast<uint8_t>((secret_len * 8) >> (8 * i)));
+    const std::string suffix = "&admin=true";
+    forged.insert(forged.end(), suffix.begin(), suffix.end());
+    SM3Hash extended(SM3Hash::midstate_from_digest(secret_digest.data(), padded));
+    extended.update(suffix);
+    midstate_ok = midstate_ok && extended.final() == sm3.compute(forged.data(), forged.size());
+    std::cout << "链接状态导出/恢复与长度扩展: " << (midstate_ok ? "Passed" : "Failed") << "\n";
+
+    // 1KB公共前缀 + 32字节消息：每次从头计算与从链接状态继续
+    std::vector<uint8_t> shared(1024 + 32, 0x5c);
+    SM3Hash shared_ctx;
+    shared_ctx.update(shared.data(), 1024);
+    shared_ctx.export_midstate(prefix);
+    start = std::chrono::high_resolution_clock::now();
+    for (int i = 0; i < rounds / 10; ++i) {
+        shared[1024] = static_cast<uint8_t>(i);
+        SM3Hash::Digest digest;
+        SM3Hash::hash(shared.data(), shared.size(), digest);
+        shared[1025] ^= digest[0];
+    }
+    mid = std::chrono::high_resolution_clock::now();
+    for (int i = 0; i < rounds / 10; ++i) {
+        shared[1024] = static_cast<uint8_t>(i);
+        SM3Hash::Digest digest;
+        SM3Hash::hash(prefix, shared.data() + 1024, 32, digest.data());
+        shared[1025] ^= digest[0];
+    }
+    end = std::chrono::high_resolution_clock::now();
+    std::cout << "1KB公共前缀: 完整计算 " << rounds / 10 / std::chrono::duration<double>(mid - start).count()
+              << " 次/秒, 链接状态 " << rounds / 10 / std::chrono::duration<double>(end - mid).count() << " 次/秒\n";
+
     return 0;
 }
     
\ No newline at end of file